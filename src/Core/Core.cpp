@@ -8,6 +8,7 @@
 #include "Core.h"
 
 #include "memory/memory.h"
+#include "r4300/r4300.h"
 
 core_params* g_core{};
 std::atomic<int32_t> g_wait_counter = 0;
@@ -86,6 +87,8 @@ core_result core_init(core_params* params)
     });
     DEFAULT_FUNC(debugger_cpu_state_changed, [](core_dbg_cpu_state*) {
     });
+    DEFAULT_FUNC(debugger_watch_hit, [](const core_dbg_watch_hit*) {
+    });
     DEFAULT_FUNC(lag_limit_exceeded, [] {
     });
     DEFAULT_FUNC(seek_status_changed, [] {
@@ -130,4 +133,5 @@ void core_vr_wait_increment()
 void core_vr_wait_decrement()
 {
     --g_wait_counter;
+    emu_thread_notify();
 }
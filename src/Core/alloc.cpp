@@ -45,3 +45,30 @@ void free_exec(void* ptr)
 #error "free_exec not implemented for this platform"
 #endif
 }
+
+void* reserve_exec(size_t size)
+{
+#ifdef WIN32
+    return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+#error "reserve_exec not implemented for this platform"
+#endif
+}
+
+bool commit_exec(void* ptr, size_t size)
+{
+#ifdef WIN32
+    return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_EXECUTE_READWRITE) != NULL;
+#else
+#error "commit_exec not implemented for this platform"
+#endif
+}
+
+void release_exec(void* ptr, size_t size)
+{
+#ifdef WIN32
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+#error "release_exec not implemented for this platform"
+#endif
+}
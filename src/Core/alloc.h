@@ -9,3 +9,25 @@
 void* malloc_exec(size_t size);
 void* realloc_exec(void* ptr, size_t oldsize, size_t newsize);
 void free_exec(void* ptr);
+
+/**
+ * \brief Reserves a range of address space for executable memory without committing it.
+ * \param size The size of the range in bytes.
+ * \return The start of the range, or nullptr if the operation failed.
+ */
+void* reserve_exec(size_t size);
+
+/**
+ * \brief Commits a part of a range reserved with <c>reserve_exec</c>, making it readable, writable and executable.
+ * \param ptr The start of the part to commit. Must be page-aligned.
+ * \param size The size of the part in bytes.
+ * \return Whether the operation succeeded.
+ */
+bool commit_exec(void* ptr, size_t size);
+
+/**
+ * \brief Releases a range reserved with <c>reserve_exec</c>.
+ * \param ptr The start of the range.
+ * \param size The size of the range in bytes.
+ */
+void release_exec(void* ptr, size_t size);
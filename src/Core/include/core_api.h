@@ -52,6 +52,7 @@ typedef struct {
     void (*dacrate_changed)(core_system_type);
     void (*debugger_resumed_changed)(bool);
     void (*debugger_cpu_state_changed)(core_dbg_cpu_state*);
+    void (*debugger_watch_hit)(const core_dbg_watch_hit*);
     void (*lag_limit_exceeded)(void);
     void (*seek_status_changed)(void);
 } core_callbacks;
@@ -295,11 +296,6 @@ typedef struct {
 #pragma region Core-Provided
     core_controller controls[4];
 
-    core_timer_delta g_frame_deltas[core_timer_max_deltas];
-    std::mutex g_frame_deltas_mutex;
-    core_timer_delta g_vi_deltas[core_timer_max_deltas];
-    std::mutex g_vi_deltas_mutex;
-
     uint8_t* rom;
     uint32_t* rdram;
     core_rdram_reg* rdram_register;
@@ -470,6 +466,18 @@ EXPORT std::wstring CALL core_vr_country_code_to_country_name(uint16_t country_c
  */
 EXPORT void CALL core_vr_on_speed_modifier_changed();
 
+/**
+ * \brief Gets rolling statistics over the most recent frame and VI timings.
+ * \remarks This function doesn't block the emulation thread and can be called from any thread at any frequency.
+ */
+EXPORT core_timer_info CALL core_vr_get_timer_info();
+
+/**
+ * \brief Gets statistics about the dynamic recompiler's code cache.
+ * \remarks This function doesn't block the emulation thread and can be called from any thread at any frequency.
+ */
+EXPORT core_code_cache_stats CALL core_vr_get_code_cache_stats();
+
 /**
  * \brief Invalidates the visuals, allowing an updateScreen call to happen.
  */
@@ -764,6 +772,24 @@ EXPORT void CALL core_dbg_set_rsp_enabled(bool);
  */
 EXPORT char* CALL core_dbg_disassemble(char* buf, uint32_t w, uint32_t pc);
 
+/**
+ * \brief Adds a watch over a memory range. The debugger_watch_hit callback is invoked on the emulation thread for each matching access.
+ * \param address The range's start address. Both virtual (KSEG0/KSEG1) and physical addresses are accepted.
+ * \param size The range's size in bytes.
+ * \param kinds The kinds of accesses to watch, as a combination of core_dbg_watch_kind flags.
+ * \param id The watch's identifier.
+ * \return The operation result.
+ * \remarks Only the 64 KB regions overlapping a read or write watch lose the fast memory paths. Execution watches are only reported for unmapped code under the pure interpreter, so adding one under another core fails with DBG_ExecWatchUnsupported.
+ */
+EXPORT core_result CALL core_dbg_add_watch(uint32_t address, uint32_t size, uint32_t kinds, uint32_t* id);
+
+/**
+ * \brief Removes a watch.
+ * \param id The watch's identifier.
+ * \return The operation result.
+ */
+EXPORT core_result CALL core_dbg_remove_watch(uint32_t id);
+
 #pragma endregion
 
 #pragma region Cheats
@@ -89,6 +89,8 @@ typedef enum {
     ST_EventQueueTooLong,
     // The CPU registers contained invalid values
     ST_InvalidRegisters,
+    // The savestate was created by a newer version of the core
+    ST_UnsupportedVersion,
 #pragma endregion
 
 #pragma region Plugins
@@ -97,6 +99,15 @@ typedef enum {
     // The plugin doesn't export a GetDllInfo function
     Pl_NoGetDllInfo,
 #pragma endregion
+
+#pragma region Debugger
+    // The watch range or kind is invalid
+    DBG_InvalidWatch,
+    // No watch with the provided identifier exists
+    DBG_WatchNotFound,
+    // Execution watches aren't supported by the selected core
+    DBG_ExecWatchUnsupported,
+#pragma endregion
 } core_result;
 
 struct core_cfg {
@@ -193,11 +204,22 @@ struct core_cfg {
     /// </summary>
     int32_t is_audio_delay_enabled = 1;
 
+    /// <summary>
+    /// The maximum time the audio thread waits for an AI event before updating the audio plugin anyway, in milliseconds.
+    /// During fast-forward, this is also the interval at which audio updates are batched.
+    /// </summary>
+    int32_t audio_update_timeout = 5;
+
     /// <summary>
     /// Whether jmp instructions will cause the following code to be JIT'd by dynarec
     /// </summary>
     int32_t is_compiled_jump_enabled = 1;
 
+    /// <summary>
+    /// The size of the dynamic recompiler's code cache in megabytes. When half of it is filled, all compiled code is flushed.
+    /// </summary>
+    int32_t code_cache_size = 64;
+
     /// <summary>
     /// The save interval for warp modify savestates in frames
     /// </summary>
@@ -208,6 +230,24 @@ struct core_cfg {
     /// </summary>
     int32_t seek_savestate_max_count = 20;
 
+    /// <summary>
+    /// Whether seek savestates are stored as page deltas against a previous seek savestate instead of in full
+    /// </summary>
+    int32_t seek_savestate_delta = 1;
+
+    /// <summary>
+    /// The codec used to compress seek savestates in the background
+    /// 0 - None
+    /// 1 - Deflate
+    /// </summary>
+    int32_t seek_savestate_codec = 1;
+
+    /// <summary>
+    /// The maximum total size of seek savestates kept in memory, in megabytes
+    /// 0 - unlimited
+    /// </summary>
+    int32_t seek_savestate_max_size = 1024;
+
     /// <summary>
     /// The movie frame to automatically pause at
     /// -1 none
@@ -235,6 +275,12 @@ struct core_cfg {
     /// </summary>
     int32_t vcr_write_extended_format = 1;
 
+    /// <summary>
+    /// Whether movie writes are committed to the disk before being considered complete.
+    /// Protects the movie file against system crashes and power loss at the cost of slower writes.
+    /// </summary>
+    int32_t vcr_fsync = 0;
+
     /// <summary>
     /// The maximum amount of VIs allowed to be generated since the last input poll before a warning dialog is shown
     /// 0 - no warning
@@ -257,6 +303,52 @@ struct core_cfg {
 typedef std::common_type_t<std::chrono::duration<int64_t, std::ratio<1, 1000000000>>, std::chrono::duration<int64_t, std::ratio<1, 1000000000>>> core_timer_delta;
 constexpr uint8_t core_timer_max_deltas = 60;
 
+/**
+ * \brief Rolling statistics over the most recent timer deltas.
+ */
+typedef struct {
+    /// The shortest delta.
+    core_timer_delta min;
+    /// The mean delta.
+    core_timer_delta avg;
+    /// The 95th percentile delta.
+    core_timer_delta p95;
+    /// The 99th percentile delta.
+    core_timer_delta p99;
+    /// The longest delta.
+    core_timer_delta max;
+    /// The average rate of entries per second (e.g.: FPS for frame deltas), or 0 if no deltas have been recorded yet.
+    double rate;
+} core_timer_stats;
+
+/**
+ * \brief Rolling frame and VI timing statistics.
+ */
+typedef struct {
+    /// Statistics over the frame deltas.
+    core_timer_stats frame;
+    /// Statistics over the VI deltas.
+    core_timer_stats vi;
+    /// The emulation speed as a percentage of the rom's intended VI rate.
+    double speed;
+} core_timer_info;
+
+/**
+ * \brief Statistics about the dynamic recompiler's code cache.
+ */
+typedef struct {
+    /// The amount of bytes occupied by code in the current cache generation.
+    size_t bytes_used;
+    /// The amount of address space reserved for the cache.
+    size_t bytes_reserved;
+    /// The amount of block compilations since the core was started.
+    uint64_t blocks_compiled;
+    /// The amount of cache flushes since the core was started.
+    uint64_t flushes;
+    /// The total time spent compiling blocks since the core was started.
+    std::chrono::nanoseconds compile_time;
+} core_code_cache_stats;
+
 typedef struct {
     uint32_t rdram_config;
     uint32_t rdram_device_id;
@@ -657,6 +749,17 @@ typedef enum {
     task_playback
 } core_vcr_task;
 
+/**
+ * \brief An immutable snapshot of movie inputs, split into fixed-size chunks. Chunks are shared between snapshots for as long as their contents don't change.
+ */
+typedef struct {
+    /// The chunks. All chunks except the last one are full.
+    std::vector<std::shared_ptr<const std::vector<core_buttons>>> chunks;
+
+    /// The total amount of inputs in the snapshot.
+    size_t size;
+} core_vcr_input_snapshot;
+
 /**
  * \brief The movie freeze buffer, which is used to store the movie (with only essential data) associated with a savestate inside the savestate.
  */
@@ -666,7 +769,8 @@ typedef struct {
     uint32_t current_sample;
     uint32_t current_vi;
     uint32_t length_samples;
-    std::vector<core_buttons> input_buffer;
+    /// The movie inputs. When serialized, this is followed by one garbage sample for compatibility, which isn't part of the snapshot.
+    core_vcr_input_snapshot input_buffer;
 } core_vcr_freeze_info;
 
 #pragma endregion
@@ -679,6 +783,34 @@ typedef struct
     uint32_t address;
 } core_dbg_cpu_state;
 
+/**
+ * \brief The kinds of accesses a watch can be triggered by.
+ */
+typedef enum {
+    core_dbg_watch_read = 1 << 0,
+    core_dbg_watch_write = 1 << 1,
+    core_dbg_watch_exec = 1 << 2,
+} core_dbg_watch_kind;
+
+/**
+ * \brief Describes an access which triggered a watch.
+ */
+typedef struct
+{
+    /// The watch's identifier.
+    uint32_t id;
+    /// The kind of access.
+    core_dbg_watch_kind kind;
+    /// The accessed address.
+    uint32_t address;
+    /// The access size in bytes.
+    uint32_t size;
+    /// The value which was read or written. Zero for executions.
+    uint64_t value;
+    /// The program counter at the time of the access. Zero under the dynamic recompiler, which doesn't keep track of it.
+    uint32_t pc;
+} core_dbg_watch_hit;
+
 #pragma endregion
 
 #pragma region Cheats
@@ -733,10 +865,23 @@ struct core_st_callback_info {
     core_st_job job{};
     core_st_medium medium{};
     core_st_job_params params{};
+
+    /// The time it took to perform the job, measured from when the savestate system started working on it.
+    std::chrono::nanoseconds duration{};
 };
 
 using core_st_callback = std::function<void(const core_st_callback_info&, const std::vector<uint8_t>&)>;
 
+/**
+ * \brief Represents a codec used to compress in-memory savestates.
+ */
+typedef enum {
+    // No compression
+    core_st_codec_none,
+    // Raw DEFLATE at the fastest compression level
+    core_st_codec_deflate,
+} core_st_codec;
+
 #pragma endregion
 
 #pragma region Host API Types
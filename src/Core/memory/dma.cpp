@@ -9,6 +9,7 @@
 #include "flashram.h"
 #include "memory.h"
 #include "pif.h"
+#include "savefile.h"
 #include "savestates.h"
 #include "summercart.h"
 #include <Core.h>
@@ -29,14 +30,12 @@ void dma_pi_read()
     {
         if (use_flashram != 1)
         {
-            fseek(g_sram_file, 0, SEEK_SET);
-            fread(sram, 1, 0x8000, g_sram_file);
+            savefile_read(g_sram_file, sram, 0x8000);
 
             for (i = 0; i < (pi_register.pi_rd_len_reg & 0xFFFFFF) + 1; i++)
                 sram[((pi_register.pi_cart_addr_reg - 0x08000000) + i) ^ S8] = ((unsigned char*)rdram)[(pi_register.pi_dram_addr_reg + i) ^ S8];
 
-            fseek(g_sram_file, 0, SEEK_SET);
-            fwrite(sram, 1, 0x8000, g_sram_file);
+            savefile_write(g_sram_file, sram, 0x8000);
             use_flashram = -1;
         }
         else
@@ -95,8 +94,7 @@ void dma_pi_write()
         {
             if (use_flashram != 1)
             {
-                fseek(g_sram_file, 0, SEEK_SET);
-                fread(sram, 1, 0x8000, g_sram_file);
+                savefile_read(g_sram_file, sram, 0x8000);
 
                 for (i = 0; i < (pi_register.pi_wr_len_reg & 0xFFFFFF) + 1; i++)
                     ((unsigned char*)rdram)[(pi_register.pi_dram_addr_reg + i) ^ S8] =
@@ -10,6 +10,7 @@
 #include "flashram.h"
 #include "pif.h"
 #include "summercart.h"
+#include "watchpoints.h"
 #include <Core.h>
 #include <r4300/interrupt.h>
 #include <r4300/macros.h>
@@ -97,6 +98,12 @@ static core_fb_info frameBufferInfos[6];
 static char framebufferRead[0x800];
 static int32_t firstFrameBufferSetting;
 
+// For each 4 KB RDRAM page, the amount of framebuffers covering it entirely, or FB_PAGE_PARTIAL if a framebuffer only covers part of it
+static uint8_t framebufferPages[0x800];
+constexpr uint8_t FB_PAGE_PARTIAL = 0x80;
+
+static void update_framebuffer_pages();
+
 static const int32_t MemoryMaxCount = 0xFFFF;
 
 size_t core_vr_get_lag_count()
@@ -1016,9 +1023,13 @@ int32_t init_memory()
     init_flashram();
 
     frameBufferInfos[0].addr = 0;
+    memset(framebufferPages, 0, sizeof(framebufferPages));
     fast_memory = 1;
     firstFrameBufferSetting = 1;
 
+    // The tables were rebuilt from scratch, so any watched regions need their watch handlers back
+    watch_refresh_handlers();
+
     g_core->log_info(L"memory initialized");
     return 0;
 }
@@ -1200,6 +1211,8 @@ void update_SP()
                         }
                     }
                 }
+
+                watch_refresh_handlers();
             }
 
             // processDList();
@@ -1228,6 +1241,7 @@ void update_SP()
             if (g_core->plugin_funcs.video_fb_get_frame_buffer_info && g_core->plugin_funcs.video_fb_read && g_core->plugin_funcs.video_fb_write)
             {
                 g_core->plugin_funcs.video_fb_get_frame_buffer_info(frameBufferInfos);
+                update_framebuffer_pages();
             }
 
             if (g_core->plugin_funcs.video_fb_get_frame_buffer_info && g_core->plugin_funcs.video_fb_read && g_core->plugin_funcs.video_fb_write && frameBufferInfos[0].addr)
@@ -1281,6 +1295,8 @@ void update_SP()
                         }
                     }
                 }
+
+                watch_refresh_handlers();
             }
         }
         else if (SP_DMEM[0xFC0 / 4] == 2)
@@ -1495,28 +1511,47 @@ void read_rdramd()
     ((*(uint32_t*)(rdramb + (address & 0xFFFFFF) + 4)));
 }
 
-void read_rdramFB()
+static void update_framebuffer_pages()
 {
-    int32_t i;
-    for (i = 0; i < 6; i++)
+    memset(framebufferPages, 0, sizeof(framebufferPages));
+    for (int32_t i = 0; i < 6; i++)
     {
-        if (frameBufferInfos[i].addr)
+        if (!frameBufferInfos[i].addr)
         {
-            int32_t start = frameBufferInfos[i].addr & 0x7FFFFF;
-            int32_t end = start + frameBufferInfos[i].width * frameBufferInfos[i].height * frameBufferInfos[i].size - 1;
-            if ((address & 0x7FFFFF) >= start && (address & 0x7FFFFF) <= end &&
-                framebufferRead[(address & 0x7FFFFF) >> 12])
+            continue;
+        }
+
+        // NOTE: This mirrors the (wrapping) extent computation in the notify functions below, which mustn't change as it decides when the video plugin is called
+        const uint32_t start = frameBufferInfos[i].addr & 0x7FFFFF;
+        const uint32_t end = start + frameBufferInfos[i].width * frameBufferInfos[i].height * frameBufferInfos[i].size - 1;
+        if (end < start)
+        {
+            continue;
+        }
+        const uint32_t last = std::min(end, (uint32_t)0x7FFFFF);
+
+        for (uint32_t page = start >> 12; page <= last >> 12; page++)
+        {
+            if (start <= page << 12 && last >= (page << 12) + 0xFFF && framebufferPages[page] + 1 < FB_PAGE_PARTIAL)
             {
-                g_core->plugin_funcs.video_fb_read(address);
-                framebufferRead[(address & 0x7FFFFF) >> 12] = 0;
+                framebufferPages[page]++;
+            }
+            else
+            {
+                framebufferPages[page] |= FB_PAGE_PARTIAL;
             }
         }
     }
-    read_rdram();
 }
 
-void read_rdramFBb()
+static void notify_framebuffer_read()
 {
+    const uint32_t page = (address & 0x7FFFFF) >> 12;
+    if (!framebufferRead[page] || !framebufferPages[page])
+    {
+        return;
+    }
+
     int32_t i;
     for (i = 0; i < 6; i++)
     {
@@ -1532,31 +1567,26 @@ void read_rdramFBb()
             }
         }
     }
-    read_rdramb();
 }
 
-void read_rdramFBh()
+static void notify_framebuffer_write(uint32_t addr, uint32_t size)
 {
-    int32_t i;
-    for (i = 0; i < 6; i++)
+    const uint8_t page = framebufferPages[(address & 0x7FFFFF) >> 12];
+    if (!page)
     {
-        if (frameBufferInfos[i].addr)
+        return;
+    }
+
+    // Pages covered entirely get one notification per framebuffer, same as the exact check below would produce
+    if (!(page & FB_PAGE_PARTIAL))
+    {
+        for (uint8_t j = 0; j < page; j++)
         {
-            int32_t start = frameBufferInfos[i].addr & 0x7FFFFF;
-            int32_t end = start + frameBufferInfos[i].width * frameBufferInfos[i].height * frameBufferInfos[i].size - 1;
-            if ((address & 0x7FFFFF) >= start && (address & 0x7FFFFF) <= end &&
-                framebufferRead[(address & 0x7FFFFF) >> 12])
-            {
-                g_core->plugin_funcs.video_fb_read(address);
-                framebufferRead[(address & 0x7FFFFF) >> 12] = 0;
-            }
+            g_core->plugin_funcs.video_fb_write(addr, size);
         }
+        return;
     }
-    read_rdramh();
-}
 
-void read_rdramFBd()
-{
     int32_t i;
     for (i = 0; i < 6; i++)
     {
@@ -1564,14 +1594,33 @@ void read_rdramFBd()
         {
             int32_t start = frameBufferInfos[i].addr & 0x7FFFFF;
             int32_t end = start + frameBufferInfos[i].width * frameBufferInfos[i].height * frameBufferInfos[i].size - 1;
-            if ((address & 0x7FFFFF) >= start && (address & 0x7FFFFF) <= end &&
-                framebufferRead[(address & 0x7FFFFF) >> 12])
-            {
-                g_core->plugin_funcs.video_fb_read(address);
-                framebufferRead[(address & 0x7FFFFF) >> 12] = 0;
-            }
+            if ((address & 0x7FFFFF) >= start && (address & 0x7FFFFF) <= end)
+                g_core->plugin_funcs.video_fb_write(addr, size);
         }
     }
+}
+
+void read_rdramFB()
+{
+    notify_framebuffer_read();
+    read_rdram();
+}
+
+void read_rdramFBb()
+{
+    notify_framebuffer_read();
+    read_rdramb();
+}
+
+void read_rdramFBh()
+{
+    notify_framebuffer_read();
+    read_rdramh();
+}
+
+void read_rdramFBd()
+{
+    notify_framebuffer_read();
     read_rdramd();
 }
 
@@ -1598,65 +1647,25 @@ void write_rdramd()
 
 void write_rdramFB()
 {
-    int32_t i;
-    for (i = 0; i < 6; i++)
-    {
-        if (frameBufferInfos[i].addr)
-        {
-            int32_t start = frameBufferInfos[i].addr & 0x7FFFFF;
-            int32_t end = start + frameBufferInfos[i].width * frameBufferInfos[i].height * frameBufferInfos[i].size - 1;
-            if ((address & 0x7FFFFF) >= start && (address & 0x7FFFFF) <= end)
-                g_core->plugin_funcs.video_fb_write(address, 4);
-        }
-    }
+    notify_framebuffer_write(address, 4);
     write_rdram();
 }
 
 void write_rdramFBb()
 {
-    int32_t i;
-    for (i = 0; i < 6; i++)
-    {
-        if (frameBufferInfos[i].addr)
-        {
-            int32_t start = frameBufferInfos[i].addr & 0x7FFFFF;
-            int32_t end = start + frameBufferInfos[i].width * frameBufferInfos[i].height * frameBufferInfos[i].size - 1;
-            if ((address & 0x7FFFFF) >= start && (address & 0x7FFFFF) <= end)
-                g_core->plugin_funcs.video_fb_write(address ^ S8, 1);
-        }
-    }
+    notify_framebuffer_write(address ^ S8, 1);
     write_rdramb();
 }
 
 void write_rdramFBh()
 {
-    int32_t i;
-    for (i = 0; i < 6; i++)
-    {
-        if (frameBufferInfos[i].addr)
-        {
-            int32_t start = frameBufferInfos[i].addr & 0x7FFFFF;
-            int32_t end = start + frameBufferInfos[i].width * frameBufferInfos[i].height * frameBufferInfos[i].size - 1;
-            if ((address & 0x7FFFFF) >= start && (address & 0x7FFFFF) <= end)
-                g_core->plugin_funcs.video_fb_write(address ^ S16, 2);
-        }
-    }
+    notify_framebuffer_write(address ^ S16, 2);
     write_rdramh();
 }
 
 void write_rdramFBd()
 {
-    int32_t i;
-    for (i = 0; i < 6; i++)
-    {
-        if (frameBufferInfos[i].addr)
-        {
-            int32_t start = frameBufferInfos[i].addr & 0x7FFFFF;
-            int32_t end = start + frameBufferInfos[i].width * frameBufferInfos[i].height * frameBufferInfos[i].size - 1;
-            if ((address & 0x7FFFFF) >= start && (address & 0x7FFFFF) <= end)
-                g_core->plugin_funcs.video_fb_write(address, 8);
-        }
-    }
+    notify_framebuffer_write(address, 8);
     write_rdramd();
 }
 
@@ -2617,6 +2626,7 @@ void write_ai()
         ai_register.ai_len = word;
         g_core->plugin_funcs.audio_ai_len_changed();
         g_core->callbacks.ai_len_changed();
+        audio_thread_notify();
         switch (ROM_HEADER.Country_code & 0xFF)
         {
         case 0x44:
@@ -2699,6 +2709,7 @@ void write_aib()
         ai_register.ai_len = temp;
         g_core->plugin_funcs.audio_ai_len_changed();
         g_core->callbacks.ai_len_changed();
+        audio_thread_notify();
         switch (ROM_HEADER.Country_code & 0xFF)
         {
         case 0x44:
@@ -2778,6 +2789,7 @@ void write_aih()
         ai_register.ai_len = temp;
         g_core->plugin_funcs.audio_ai_len_changed();
         g_core->callbacks.ai_len_changed();
+        audio_thread_notify();
         switch (ROM_HEADER.Country_code & 0xFF)
         {
         case 0x44:
@@ -2851,6 +2863,7 @@ void write_aid()
         ai_register.ai_len = dword & 0xFFFFFFFF;
         g_core->plugin_funcs.audio_ai_len_changed();
         g_core->callbacks.ai_len_changed();
+        audio_thread_notify();
         switch (ROM_HEADER.Country_code & 0xFF)
         {
         case 0x44:
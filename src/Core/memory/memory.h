@@ -10,14 +10,6 @@
 
 int32_t init_memory();
 constexpr uint32_t ADDR_MASK = 0x7FFFFF;
-#define read_word_in_memory() readmem[address >> 16]()
-#define read_byte_in_memory() readmemb[address >> 16]()
-#define read_hword_in_memory() readmemh[address >> 16]()
-#define read_dword_in_memory() readmemd[address >> 16]()
-#define write_word_in_memory() writemem[address >> 16]()
-#define write_byte_in_memory() writememb[address >> 16]()
-#define write_hword_in_memory() writememh[address >> 16]()
-#define write_dword_in_memory() writememd[address >> 16]()
 extern uint32_t SP_DMEM[0x1000 / 4 * 2];
 extern unsigned char* SP_DMEMb;
 extern uint32_t* SP_IMEM;
@@ -246,3 +238,88 @@ void update_DPC();
  * \brief Checks whether the provided register contents are valid.
  */
 bool check_register_validity(core_si_reg* si_reg);
+
+// The memory access helpers below perform plain RDRAM accesses inline instead of calling through the handler tables.
+// The fast path is only taken when the page's handler is the plain RDRAM one, so pages with framebuffer tracking, MMIO or TLB mappings still reach their handlers.
+
+inline void read_word_in_memory()
+{
+    if (readmem[address >> 16] == read_rdram)
+    {
+        *rdword = *((uint32_t*)(rdramb + (address & 0xFFFFFF)));
+        return;
+    }
+    readmem[address >> 16]();
+}
+
+inline void read_byte_in_memory()
+{
+    if (readmemb[address >> 16] == read_rdramb)
+    {
+        *rdword = *(rdramb + ((address & 0xFFFFFF) ^ S8));
+        return;
+    }
+    readmemb[address >> 16]();
+}
+
+inline void read_hword_in_memory()
+{
+    if (readmemh[address >> 16] == read_rdramh)
+    {
+        *rdword = *((uint16_t*)(rdramb + ((address & 0xFFFFFF) ^ S16)));
+        return;
+    }
+    readmemh[address >> 16]();
+}
+
+inline void read_dword_in_memory()
+{
+    if (readmemd[address >> 16] == read_rdramd)
+    {
+        *rdword = ((uint64_t)(*(uint32_t*)(rdramb + (address & 0xFFFFFF))) << 32) |
+        ((*(uint32_t*)(rdramb + (address & 0xFFFFFF) + 4)));
+        return;
+    }
+    readmemd[address >> 16]();
+}
+
+inline void write_word_in_memory()
+{
+    if (writemem[address >> 16] == write_rdram)
+    {
+        *((uint32_t*)(rdramb + (address & 0xFFFFFF))) = word;
+        return;
+    }
+    writemem[address >> 16]();
+}
+
+inline void write_byte_in_memory()
+{
+    if (writememb[address >> 16] == write_rdramb)
+    {
+        *((rdramb + ((address & 0xFFFFFF) ^ S8))) = g_byte;
+        return;
+    }
+    writememb[address >> 16]();
+}
+
+inline void write_hword_in_memory()
+{
+    if (writememh[address >> 16] == write_rdramh)
+    {
+        *(uint16_t*)((rdramb + ((address & 0xFFFFFF) ^ S16))) = hword;
+        return;
+    }
+    writememh[address >> 16]();
+}
+
+inline void write_dword_in_memory()
+{
+    if (writememd[address >> 16] == write_rdramd)
+    {
+        *((uint32_t*)(rdramb + (address & 0xFFFFFF))) = dword >> 32;
+        *((uint32_t*)(rdramb + (address & 0xFFFFFF) + 4)) = dword & 0xFFFFFFFF;
+        return;
+    }
+    writememd[address >> 16]();
+}
@@ -9,6 +9,7 @@
 #include <memory/memory.h>
 #include <memory/pif.h>
 #include <memory/pif_lut.h>
+#include <memory/savefile.h>
 #include <memory/savestates.h>
 #include <cheats.h>
 #include <r4300/r4300.h>
@@ -62,19 +63,16 @@ void EepromCommand(uint8_t* Command)
         break;
     case 4: // read
         {
-            fseek(g_eeprom_file, 0, SEEK_SET);
-            fread(eeprom, 1, 0x800, g_eeprom_file);
+            savefile_read(g_eeprom_file, eeprom, 0x800);
             memcpy(&Command[4], eeprom + Command[3] * 8, 8);
         }
         break;
     case 5: // write
         {
-            fseek(g_eeprom_file, 0, SEEK_SET);
-            fread(eeprom, 1, 0x800, g_eeprom_file);
+            savefile_read(g_eeprom_file, eeprom, 0x800);
             memcpy(eeprom + Command[3] * 8, &Command[4], 8);
 
-            fseek(g_eeprom_file, 0, SEEK_SET);
-            fwrite(eeprom, 1, 0x800, g_eeprom_file);
+            savefile_write(g_eeprom_file, eeprom, 0x800);
         }
         break;
     default:
@@ -466,11 +464,7 @@ void internal_ControllerCommand(int32_t Control, uint8_t* Command)
                         address &= 0xFFE0;
                         if (address <= 0x7FE0)
                         {
-                            fseek(g_mpak_file, 0, SEEK_SET);
-                            fread(mempack[0], 1, 0x8000, g_mpak_file);
-                            fread(mempack[1], 1, 0x8000, g_mpak_file);
-                            fread(mempack[2], 1, 0x8000, g_mpak_file);
-                            fread(mempack[3], 1, 0x8000, g_mpak_file);
+                            savefile_read(g_mpak_file, mempack, sizeof(mempack));
 
                             memcpy(&Command[5], &mempack[Control][address], 0x20);
                         }
@@ -509,19 +503,11 @@ void internal_ControllerCommand(int32_t Control, uint8_t* Command)
                         address &= 0xFFE0;
                         if (address <= 0x7FE0)
                         {
-                            fseek(g_mpak_file, 0, SEEK_SET);
-                            fread(mempack[0], 1, 0x8000, g_mpak_file);
-                            fread(mempack[1], 1, 0x8000, g_mpak_file);
-                            fread(mempack[2], 1, 0x8000, g_mpak_file);
-                            fread(mempack[3], 1, 0x8000, g_mpak_file);
+                            savefile_read(g_mpak_file, mempack, sizeof(mempack));
 
                             memcpy(&mempack[Control][address], &Command[5], 0x20);
 
-                            fseek(g_mpak_file, 0, SEEK_SET);
-                            fwrite(mempack[0], 1, 0x8000, g_mpak_file);
-                            fwrite(mempack[1], 1, 0x8000, g_mpak_file);
-                            fwrite(mempack[2], 1, 0x8000, g_mpak_file);
-                            fwrite(mempack[3], 1, 0x8000, g_mpak_file);
+                            savefile_write(g_mpak_file, mempack, sizeof(mempack));
                         }
                         Command[0x25] = mempack_crc(&Command[5]);
                     }
@@ -686,20 +672,27 @@ void update_pif_read()
                             }
                         }
 
+                        // The waits below are woken up as soon as the state they wait on changes, the timeouts only act as a fallback
                         while (g_wait_counter)
                         {
-                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                            emu_thread_wait_until(std::chrono::steady_clock::now() + std::chrono::milliseconds(1));
                             if (stAllowed)
                             {
                                 st_do_work();
                             }
                         }
 
+                        // The interval callback keeps its 10ms period while paused, independently of how often we're woken up
+                        auto next_interval = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
                         while (emu_paused)
                         {
-                            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                            emu_thread_wait_until(next_interval);
 
-                            g_core->callbacks.interval();
+                            if (std::chrono::steady_clock::now() >= next_interval)
+                            {
+                                g_core->callbacks.interval();
+                                next_interval = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+                            }
 
                             if (stAllowed)
                             {
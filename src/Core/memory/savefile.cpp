@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include "savefile.h"
+#include <Core.h>
+
+// The interval at which modified save files are flushed in the background.
+constexpr auto SAVEFILE_FLUSH_INTERVAL = std::chrono::seconds(1);
+
+t_savefile g_eeprom_file;
+t_savefile g_sram_file;
+t_savefile g_fram_file;
+t_savefile g_mpak_file;
+
+// Locked while writing a save file to disk, so flushes of the same file can't interleave.
+std::mutex g_savefile_write_mutex;
+
+// The generation of the last flush written to disk for each backing file.
+std::unordered_map<std::wstring, uint64_t> g_savefile_written_generations;
+
+// Locked when accessing the pending flush count.
+std::mutex g_savefile_flush_mutex;
+
+// Signalled when a pending asynchronous flush completes.
+std::condition_variable g_savefile_flush_cv;
+
+// The amount of asynchronous flushes which are queued or currently being written.
+size_t g_savefile_pending_flushes = 0;
+
+std::chrono::steady_clock::time_point g_savefile_last_flush;
+
+/**
+ * \brief Writes a snapshot of a save file to disk, unless a newer snapshot was already written.
+ */
+static void savefile_write_to_disk(const std::filesystem::path& path, const std::vector<uint8_t>& data, uint64_t generation)
+{
+    std::scoped_lock lock(g_savefile_write_mutex);
+
+    auto& written_generation = g_savefile_written_generations[path.wstring()];
+    if (written_generation > generation)
+    {
+        return;
+    }
+    written_generation = generation;
+
+    FILE* f = nullptr;
+    if (fopen_s(&f, path.string().c_str(), "wb"))
+    {
+        g_core->log_error(std::format(L"[Core] Failed to write save file {}", path.wstring()));
+        return;
+    }
+    const bool written = fwrite(data.data(), 1, data.size(), f) == data.size();
+    if (fclose(f) || !written)
+    {
+        g_core->log_error(std::format(L"[Core] Failed to write save file {}", path.wstring()));
+    }
+}
+
+/**
+ * \brief Waits until all pending asynchronous flushes have been written to disk.
+ */
+static void savefile_wait_for_flushes()
+{
+    std::unique_lock lock(g_savefile_flush_mutex);
+    g_savefile_flush_cv.wait(lock, [] {
+        return g_savefile_pending_flushes == 0;
+    });
+}
+
+bool savefile_open(t_savefile& file, const std::filesystem::path& path)
+{
+    g_core->log_info(std::format(L"[Core] Opening save file {}...", path.wstring()));
+
+    file.path = path;
+    file.data.clear();
+    file.dirty = false;
+
+    // A flush from before a reset might still be rewriting the file
+    savefile_wait_for_flushes();
+    std::scoped_lock lock(g_savefile_write_mutex);
+
+    FILE* f = nullptr;
+    if (!exists(path))
+    {
+        if (fopen_s(&f, path.string().c_str(), "w"))
+        {
+            return false;
+        }
+        fclose(f);
+        return true;
+    }
+
+    if (fopen_s(&f, path.string().c_str(), "rb"))
+    {
+        return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    file.data.resize(ftell(f));
+    fseek(f, 0, SEEK_SET);
+    fread(file.data.data(), 1, file.data.size(), f);
+    fclose(f);
+
+    return true;
+}
+
+void savefile_close(t_savefile& file)
+{
+    savefile_flush(file);
+    savefile_wait_for_flushes();
+    file.data.clear();
+    file.data.shrink_to_fit();
+}
+
+void savefile_read(const t_savefile& file, void* dest, size_t len)
+{
+    memcpy(dest, file.data.data(), std::min(len, file.data.size()));
+}
+
+void savefile_write(t_savefile& file, const void* src, size_t len)
+{
+    if (file.data.size() < len)
+    {
+        file.data.resize(len);
+    }
+    memcpy(file.data.data(), src, len);
+    file.dirty = true;
+}
+
+void savefile_flush(t_savefile& file, bool async)
+{
+    if (!file.dirty)
+    {
+        return;
+    }
+
+    file.dirty = false;
+    const auto generation = ++file.generation;
+
+    if (!async)
+    {
+        savefile_write_to_disk(file.path, file.data, generation);
+        return;
+    }
+
+    {
+        std::scoped_lock lock(g_savefile_flush_mutex);
+        ++g_savefile_pending_flushes;
+    }
+
+    g_core->submit_task([path = file.path, data = file.data, generation] {
+        savefile_write_to_disk(path, data, generation);
+
+        {
+            std::scoped_lock lock(g_savefile_flush_mutex);
+            --g_savefile_pending_flushes;
+        }
+        g_savefile_flush_cv.notify_all();
+    });
+}
+
+void savefile_flush_all(bool async)
+{
+    savefile_flush(g_eeprom_file, async);
+    savefile_flush(g_sram_file, async);
+    savefile_flush(g_fram_file, async);
+    savefile_flush(g_mpak_file, async);
+}
+
+void savefile_on_vi()
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (now - g_savefile_last_flush < SAVEFILE_FLUSH_INTERVAL)
+    {
+        return;
+    }
+    g_savefile_last_flush = now;
+
+    savefile_flush(g_eeprom_file, true);
+    savefile_flush(g_sram_file, true);
+    savefile_flush(g_fram_file, true);
+    savefile_flush(g_mpak_file, true);
+}
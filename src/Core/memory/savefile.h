@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+/// An in-memory image of a persistent game save file (EEPROM, SRAM, FlashRAM or mempak), which is written back to disk lazily.
+struct t_savefile {
+    /// The path of the backing file.
+    std::filesystem::path path;
+
+    /// The file's contents.
+    std::vector<uint8_t> data;
+
+    /// Whether the contents were modified since the last flush.
+    bool dirty;
+
+    /// The amount of flushes requested so far. Used to discard outdated asynchronous flushes.
+    uint64_t generation;
+};
+
+extern t_savefile g_eeprom_file;
+extern t_savefile g_sram_file;
+extern t_savefile g_fram_file;
+extern t_savefile g_mpak_file;
+
+/**
+ * \brief Opens a save file and reads its contents into memory, creating the backing file if it doesn't exist.
+ * \param file The save file.
+ * \param path The path of the backing file.
+ * \return Whether the operation succeeded.
+ */
+bool savefile_open(t_savefile& file, const std::filesystem::path& path);
+
+/**
+ * \brief Flushes a save file to disk and clears its contents from memory. Waits for pending asynchronous flushes to complete.
+ * \param file The save file.
+ */
+void savefile_close(t_savefile& file);
+
+/**
+ * \brief Reads from the start of a save file. If the file is shorter than the requested length, the rest of the destination is left untouched.
+ * \param file The save file.
+ * \param dest The destination buffer.
+ * \param len The amount of bytes to read.
+ */
+void savefile_read(const t_savefile& file, void* dest, size_t len);
+
+/**
+ * \brief Writes to the start of a save file, growing it if needed. The write is only reflected on disk after the next flush.
+ * \param file The save file.
+ * \param src The source buffer.
+ * \param len The amount of bytes to write.
+ */
+void savefile_write(t_savefile& file, const void* src, size_t len);
+
+/**
+ * \brief Writes a save file's contents to disk if they were modified.
+ * \param file The save file.
+ * \param async Whether the disk write should happen on a worker thread.
+ */
+void savefile_flush(t_savefile& file, bool async = false);
+
+/**
+ * \brief Writes all modified save files to disk.
+ * \param async Whether the disk writes should happen on a worker thread.
+ */
+void savefile_flush_all(bool async = false);
+
+/**
+ * \brief Notifies the save file system about a new VI. Periodically flushes modified save files in the background.
+ */
+void savefile_on_vi();
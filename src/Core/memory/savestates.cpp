@@ -11,10 +11,12 @@
 #include <r4300/interrupt.h>
 #include <r4300/r4300.h>
 #include <r4300/rom.h>
+#include <r4300/vcr.h>
 #include <include/core_api.h>
 #include <IOHelpers.h>
 #include "flashram.h"
 #include "memory.h"
+#include "savefile.h"
 #include "summercart.h"
 
 // st that comes from no delay fix mupen, it has some differences compared to new st:
@@ -56,20 +58,107 @@ char g_flashram_buf[1024]{};
 // Buffer used for storing event queue data during loading
 char g_event_queue_buf[1024]{};
 
-// Buffer used for storing st data up to event queue
+// Buffer used for storing st data up to event queue, laid out like in the legacy format
 uint8_t g_first_block[0xA02BB4 - 32]{};
 
+// Prefix of versioned savestates. Legacy savestates start with the rom's md5 hex string instead, which can't contain 'M'.
+constexpr char ST_MAGIC[4] = {'M', '6', '4', 'S'};
+
+// The savestate format version written by the core. Legacy savestates have no version and are treated as version 1.
+// 2: The TLB lookup tables aren't stored and are rebuilt from the TLB entries on load.
+// 3: A u32 of ST_FLAG_* flags follows the version. If ST_FLAG_TLB_LUTS is set, the full TLB lookup tables follow the flags.
+constexpr uint32_t ST_VERSION = 3;
+
+// The savestate contains the full TLB lookup tables, as they couldn't be rebuilt from the TLB entries. See tlb_luts_diverged.
+constexpr uint32_t ST_FLAG_TLB_LUTS = 1;
+
+// Buffer used for storing the full TLB lookup tables during loading. Empty if the savestate doesn't contain them.
+std::vector<uint32_t> g_tlb_luts_buf;
+
+// Offset of the TLB lookup tables in the first block, and their size in the legacy format.
+// NOTE: The legacy format only stores the first 0x100000 bytes of each table.
+constexpr size_t ST_TLB_LUT_OFFSET = 0x802208 - 0x20;
+constexpr size_t ST_TLB_LUT_SIZE = 0x100000 * 2;
+
 // The undo savestate buffer.
 std::vector<uint8_t> g_undo_savestate;
 
+/// Represents a pending savestate file write, which is compressed and written on a worker thread.
+struct t_savestate_write {
+    /// The task which produced the savestate.
+    t_savestate_task task;
+
+    /// The path the savestate will be written to.
+    std::filesystem::path path;
+
+    /// The uncompressed savestate buffer.
+    std::shared_ptr<std::vector<uint8_t>> buffer;
+};
+
+// The maximum amount of savestate writes which can be pending at once. The emulation thread blocks when this limit is reached.
+constexpr size_t ST_MAX_PENDING_WRITES = 4;
+
+// The write queue mutex. Locked when accessing the write queue or the pending write count.
+std::mutex g_write_mutex;
+
+// Signalled when a pending savestate write completes.
+std::condition_variable g_write_cv;
+
+// The write queue, processed in order by a single worker at a time.
+std::deque<t_savestate_write> g_writes;
+
+// The amount of savestate writes which are queued or currently being processed.
+size_t g_pending_writes = 0;
+
+// Whether a worker is currently processing the write queue.
+bool g_write_worker_active = false;
+
+// The buffer pool mutex. Locked when accessing the buffer pool.
+std::mutex g_buffer_pool_mutex;
+
+// Previously used savestate buffers, kept around to avoid reallocating ~11MB for every savestate.
+std::vector<std::vector<uint8_t>> g_buffer_pool;
+
+// The granularity at which savestate deltas are computed. Matches the TLB page size.
+constexpr size_t ST_DELTA_PAGE_SIZE = 0x1000;
+
 void get_paths_for_task(const t_savestate_task& task, std::filesystem::path& st_path, std::filesystem::path& sd_path)
 {
     sd_path = g_core->get_saves_directory() / (const char*)ROM_HEADER.nom;
     sd_path.replace_extension(".vhd");
 }
 
+/**
+ * Invalidates the compiled code which can't be reused after loading a savestate.
+ * Code in RDRAM pages whose contents are left unchanged by the savestate is kept, so repeated loads (e.g.: while seeking) don't have to recompile everything.
+ * \param new_rdram The RDRAM contents about to be loaded.
+ */
+static void invalidate_code_for_load(const uint8_t* new_rdram)
+{
+    constexpr uint32_t kseg0_rdram_page = 0x80000000 >> 12;
+    constexpr uint32_t kseg1_rdram_page = 0xA0000000 >> 12;
+    constexpr uint32_t rdram_pages = 0x800000 >> 12;
+
+    // TLB mappings, SP memory and the like can change with the savestate, so we only ever keep code in directly mapped RDRAM
+    for (uint32_t page = 0; page < std::size(invalid_code); page++)
+    {
+        if ((page >= kseg0_rdram_page && page < kseg0_rdram_page + rdram_pages) ||
+            (page >= kseg1_rdram_page && page < kseg1_rdram_page + rdram_pages))
+            continue;
+        invalid_code[page] = 1;
+    }
 
-void load_memory_from_buffer(uint8_t* p)
+    const auto old_rdram = (const uint8_t*)rdram;
+    for (uint32_t page = 0; page < rdram_pages; page++)
+    {
+        if (!memcmp(old_rdram + page * 0x1000, new_rdram + page * 0x1000, 0x1000))
+            continue;
+        invalid_code[kseg0_rdram_page + page] = 1;
+        invalid_code[kseg1_rdram_page + page] = 1;
+    }
+}
+
+void load_memory_from_buffer(uint8_t* p, bool has_tlb_luts)
 {
     memread(&p, &rdram_register, sizeof(core_rdram_reg));
     memread(&p, &MI_register, sizeof(core_mips_reg));
@@ -82,6 +171,8 @@ void load_memory_from_buffer(uint8_t* p)
     memread(&p, &ai_register, sizeof(core_ai_reg));
     memread(&p, &dpc_register, sizeof(core_dpc_reg));
     memread(&p, &dps_register, sizeof(core_dps_reg));
+    if (dynacore || !interpcore)
+        invalidate_code_for_load(p);
     memread(&p, rdram, 0x800000);
     memread(&p, SP_DMEM, 0x1000);
     memread(&p, SP_IMEM, 0x1000);
@@ -91,8 +182,15 @@ void load_memory_from_buffer(uint8_t* p)
     memread(&p, buf, 24);
     load_flashram_infos(buf);
 
-    memread(&p, tlb_LUT_r, 0x100000);
-    memread(&p, tlb_LUT_w, 0x100000);
+    if (has_tlb_luts)
+    {
+        memread(&p, tlb_LUT_r, 0x100000);
+        memread(&p, tlb_LUT_w, 0x100000);
+    }
+    else
+    {
+        p += ST_TLB_LUT_SIZE;
+    }
 
     memread(&p, &llbit, 4);
     memread(&p, reg, 32 * 8);
@@ -107,14 +205,28 @@ void load_memory_from_buffer(uint8_t* p)
     memread(&p, &FCR0, 4);
     memread(&p, &FCR31, 4);
     memread(&p, tlb_e, 32 * sizeof(tlb));
+    if (!g_tlb_luts_buf.empty())
+    {
+        memcpy(tlb_LUT_r, g_tlb_luts_buf.data(), sizeof(tlb_LUT_r));
+        memcpy(tlb_LUT_w, g_tlb_luts_buf.data() + std::size(tlb_LUT_r), sizeof(tlb_LUT_w));
+        tlb_luts_diverged = true;
+    }
+    else if (!has_tlb_luts)
+    {
+        tlb_rebuild_luts();
+        tlb_luts_diverged = false;
+    }
+    else
+    {
+        // Legacy savestates only contain part of the tables, so we can't tell whether they match the TLB entries
+        tlb_luts_diverged = true;
+    }
     if (!dynacore && interpcore)
         memread(&p, &interp_addr, 4);
     else
     {
         uint32_t target_addr;
         memread(&p, &target_addr, 4);
-        for (char& i : invalid_code)
-            i = 1;
         jump_to(target_addr)
     }
 
@@ -123,11 +235,145 @@ void load_memory_from_buffer(uint8_t* p)
     memread(&p, &vi_field, 4);
 }
 
-std::vector<uint8_t> generate_savestate()
+/**
+ * Gets a savestate buffer from the buffer pool, or allocates a new one if the pool is empty.
+ */
+std::vector<uint8_t> savestates_acquire_buffer()
+{
+    std::scoped_lock lock(g_buffer_pool_mutex);
+
+    if (g_buffer_pool.empty())
+    {
+        std::vector<uint8_t> buffer;
+        buffer.reserve(0xB624F0);
+        return buffer;
+    }
+
+    auto buffer = std::move(g_buffer_pool.back());
+    g_buffer_pool.pop_back();
+    buffer.clear();
+    return buffer;
+}
+
+/**
+ * Returns a savestate buffer to the buffer pool.
+ */
+void savestates_release_buffer(std::vector<uint8_t>&& buffer)
 {
-    std::vector<uint8_t> b;
+    std::scoped_lock lock(g_buffer_pool_mutex);
 
-    b.reserve(0xB624F0);
+    // More buffers than writes which can be pending at once are never needed simultaneously
+    if (g_buffer_pool.size() >= ST_MAX_PENDING_WRITES)
+    {
+        return;
+    }
+
+    g_buffer_pool.push_back(std::move(buffer));
+}
+
+/**
+ * Waits until all pending savestate writes have been completed.
+ */
+void savestates_wait_for_writes()
+{
+    std::unique_lock lock(g_write_mutex);
+    g_write_cv.wait(lock, [] {
+        return g_pending_writes == 0;
+    });
+}
+
+/**
+ * Compresses and writes the queued savestates to disk in order. Runs on a worker thread.
+ */
+void savestates_write_worker()
+{
+    const auto compressor = libdeflate_alloc_compressor(6);
+    std::vector<uint8_t> compressed_buffer;
+
+    while (true)
+    {
+        t_savestate_write write;
+        {
+            std::scoped_lock lock(g_write_mutex);
+            if (g_writes.empty())
+            {
+                g_write_worker_active = false;
+                break;
+            }
+            write = std::move(g_writes.front());
+            g_writes.pop_front();
+        }
+
+        const auto& st = *write.buffer;
+
+        compressed_buffer.resize(libdeflate_gzip_compress_bound(compressor, st.size()));
+        const size_t final_size = libdeflate_gzip_compress(compressor, st.data(), st.size(), compressed_buffer.data(), compressed_buffer.size());
+
+        core_result result = Res_Ok;
+
+        FILE* f = nullptr;
+        if (final_size == 0 || fopen_s(&f, write.path.string().c_str(), "wb"))
+        {
+            result = ST_FileWriteError;
+        }
+        else
+        {
+            const bool written = fwrite(compressed_buffer.data(), final_size, 1, f) == 1;
+            if (fclose(f) || !written)
+            {
+                result = ST_FileWriteError;
+            }
+        }
+
+        // NOTE: The pending write must be retired before invoking the callback, as the callback might enqueue more savestate work while the emu thread is waiting on us.
+        {
+            std::scoped_lock lock(g_write_mutex);
+            --g_pending_writes;
+        }
+        g_write_cv.notify_all();
+
+        write.task.callback(core_st_callback_info{
+                            .result = result,
+                            .job = write.task.job,
+                            .medium = write.task.medium,
+                            .params = write.task.params},
+                            st);
+
+        savestates_release_buffer(std::move(*write.buffer));
+    }
+
+    libdeflate_free_compressor(compressor);
+}
+
+/**
+ * Enqueues a savestate to be compressed and written to disk on a worker thread. Blocks if too many writes are pending.
+ */
+void savestates_enqueue_write(const t_savestate_task& task, const std::filesystem::path& path, std::vector<uint8_t>&& buffer)
+{
+    std::unique_lock lock(g_write_mutex);
+
+    g_write_cv.wait(lock, [] {
+        return g_pending_writes < ST_MAX_PENDING_WRITES;
+    });
+
+    g_writes.push_back(t_savestate_write{
+    .task = task,
+    .path = path,
+    .buffer = std::make_shared<std::vector<uint8_t>>(std::move(buffer)),
+    });
+    ++g_pending_writes;
+
+    if (g_write_worker_active)
+    {
+        return;
+    }
+
+    g_write_worker_active = true;
+    g_core->submit_task(savestates_write_worker);
+}
+
+void generate_savestate(std::vector<uint8_t>& b)
+{
 
     memset(g_flashram_buf, 0, sizeof(g_flashram_buf));
     memset(g_event_queue_buf, 0, sizeof(g_event_queue_buf));
@@ -139,6 +385,16 @@ std::vector<uint8_t> generate_savestate()
     save_flashram_infos(g_flashram_buf);
     const int32_t event_queue_len = save_eventqueue_infos(g_event_queue_buf);
 
+    uint32_t version = ST_VERSION;
+    const uint32_t flags = tlb_luts_diverged ? ST_FLAG_TLB_LUTS : 0;
+    vecwrite(b, (void*)ST_MAGIC, sizeof(ST_MAGIC));
+    vecwrite(b, &version, sizeof(version));
+    vecwrite(b, &flags, sizeof(flags));
+    if (flags & ST_FLAG_TLB_LUTS)
+    {
+        vecwrite(b, tlb_LUT_r, sizeof(tlb_LUT_r));
+        vecwrite(b, tlb_LUT_w, sizeof(tlb_LUT_w));
+    }
     vecwrite(b, rom_md5, 32);
     vecwrite(b, &rdram_register, sizeof(core_rdram_reg));
     vecwrite(b, &MI_register, sizeof(core_mips_reg));
@@ -156,8 +412,6 @@ std::vector<uint8_t> generate_savestate()
     vecwrite(b, SP_IMEM, 0x1000);
     vecwrite(b, PIF_RAM, 0x40);
     vecwrite(b, g_flashram_buf, 24);
-    vecwrite(b, tlb_LUT_r, 0x100000);
-    vecwrite(b, tlb_LUT_w, 0x100000);
     vecwrite(b, &llbit, 4);
     vecwrite(b, reg, 32 * 8);
     for (size_t i = 0; i < 32; i++)
@@ -184,7 +438,12 @@ std::vector<uint8_t> generate_savestate()
         vecwrite(b, &freeze.current_sample, sizeof(freeze.current_sample));
         vecwrite(b, &freeze.current_vi, sizeof(freeze.current_vi));
         vecwrite(b, &freeze.length_samples, sizeof(freeze.length_samples));
-        vecwrite(b, freeze.input_buffer.data(), freeze.input_buffer.size() * sizeof(core_buttons));
+        for (const auto& chunk : freeze.input_buffer.chunks)
+        {
+            vecwrite(b, chunk->data(), chunk->size() * sizeof(core_buttons));
+        }
+        const core_buttons garbage_sample{};
+        vecwrite(b, &garbage_sample, sizeof(garbage_sample));
     }
 
     if (core_vr_get_mge_available() && g_core->cfg->st_screenshot)
@@ -204,15 +463,18 @@ std::vector<uint8_t> generate_savestate()
 
         free(video);
     }
-
-    return b;
 }
 
 void savestates_save_immediate_impl(const t_savestate_task& task)
 {
-    // TODO: Reimplement timing
+    // Make sure the save files on disk are consistent with the savestate. Savestates kept in memory never leave the session, so they don't need it.
+    if (task.medium != core_st_medium_memory)
+    {
+        savefile_flush_all(true);
+    }
 
-    const auto st = generate_savestate();
+    auto st = savestates_acquire_buffer();
+    generate_savestate(st);
 
     if (task.medium == core_st_medium_path)
     {
@@ -223,31 +485,10 @@ void savestates_save_immediate_impl(const t_savestate_task& task)
         if (g_core->cfg->use_summercart)
             save_summercart(new_sd_path);
 
-        // Generate compressed buffer
-        std::vector<uint8_t> compressed_buffer;
-        compressed_buffer.resize(st.size());
-
-        const auto compressor = libdeflate_alloc_compressor(6);
-        const size_t final_size = libdeflate_gzip_compress(compressor, st.data(), st.size(), compressed_buffer.data(), compressed_buffer.size());
-        libdeflate_free_compressor(compressor);
-        compressed_buffer.resize(final_size);
-
-        // write compressed st to disk
-        FILE* f = nullptr;
-
-        if (fopen_s(&f, new_st_path.string().c_str(), "wb"))
-        {
-            task.callback(core_st_callback_info{
-                          .result = ST_FileWriteError,
-                          .job = task.job,
-                          .medium = task.medium,
-                          .params = task.params},
-                          st);
-            return;
-        }
-
-        fwrite(compressed_buffer.data(), compressed_buffer.size(), 1, f);
-        fclose(f);
+        // Compression and the disk write happen on a worker, which also invokes the callback once the file is written
+        savestates_enqueue_write(task, new_st_path, std::move(st));
+        g_core->callbacks.save_state();
+        return;
     }
 
     task.callback(core_st_callback_info{
@@ -256,13 +497,12 @@ void savestates_save_immediate_impl(const t_savestate_task& task)
                   .medium = task.medium,
                   .params = task.params},
                   st);
+    savestates_release_buffer(std::move(st));
     g_core->callbacks.save_state();
 }
 
 void savestates_load_immediate_impl(const t_savestate_task& task)
 {
-    // TODO: Reimplement timing
-
     memset(g_event_queue_buf, 0, sizeof(g_event_queue_buf));
 
     std::filesystem::path new_st_path = task.params.path;
@@ -277,6 +517,8 @@ void savestates_load_immediate_impl(const t_savestate_task& task)
     switch (task.medium)
     {
     case core_st_medium_path:
+        // The file might still be getting written by a previous save
+        savestates_wait_for_writes();
         st_buf = read_file_buffer(new_st_path);
         break;
     case core_st_medium_memory:
@@ -313,6 +555,36 @@ void savestates_load_immediate_impl(const t_savestate_task& task)
     // find another way of doing this
     auto ptr = decompressed_buf.data();
 
+    uint32_t version = 1;
+    if (decompressed_buf.size() >= sizeof(ST_MAGIC) && !memcmp(ptr, ST_MAGIC, sizeof(ST_MAGIC)))
+    {
+        ptr += sizeof(ST_MAGIC);
+        memread(&ptr, &version, sizeof(version));
+    }
+
+    g_tlb_luts_buf.clear();
+    if (version >= 3 && version <= ST_VERSION)
+    {
+        uint32_t flags;
+        memread(&ptr, &flags, sizeof(flags));
+        if (flags & ST_FLAG_TLB_LUTS)
+        {
+            g_tlb_luts_buf.resize(std::size(tlb_LUT_r) + std::size(tlb_LUT_w));
+            memread(&ptr, g_tlb_luts_buf.data(), g_tlb_luts_buf.size() * sizeof(uint32_t));
+        }
+    }
+
+    if (version > ST_VERSION)
+    {
+        task.callback(core_st_callback_info{
+                      .result = ST_UnsupportedVersion,
+                      .job = task.job,
+                      .medium = task.medium,
+                      .params = task.params},
+                      {});
+        return;
+    }
+
     // compare current rom hash with one stored in state
     char md5[33] = {0};
     memread(&ptr, &md5, 32);
@@ -334,7 +606,16 @@ void savestates_load_immediate_impl(const t_savestate_task& task)
     }
 
     // new version does one bigass gzread for first part of .st (static size)
-    memread(&ptr, g_first_block, sizeof(g_first_block));
+    const bool has_tlb_luts = version < 2;
+    if (has_tlb_luts)
+    {
+        memread(&ptr, g_first_block, sizeof(g_first_block));
+    }
+    else
+    {
+        memread(&ptr, g_first_block, ST_TLB_LUT_OFFSET);
+        memread(&ptr, g_first_block + ST_TLB_LUT_OFFSET + ST_TLB_LUT_SIZE, sizeof(g_first_block) - ST_TLB_LUT_OFFSET - ST_TLB_LUT_SIZE);
+    }
 
     const auto si_reg = (core_si_reg*)&g_first_block[0xDC - 0x20];
     if (!check_register_validity(si_reg) || !check_flashram_infos(&g_first_block[0x8021F0 - 0x20]))
@@ -384,8 +665,9 @@ void savestates_load_immediate_impl(const t_savestate_task& task)
         memread(&ptr, &freeze.current_vi, sizeof(freeze.current_vi));
         memread(&ptr, &freeze.length_samples, sizeof(freeze.length_samples));
 
-        freeze.input_buffer.resize(sizeof(core_buttons) * (freeze.length_samples + 1));
-        memread(&ptr, freeze.input_buffer.data(), freeze.input_buffer.size());
+        std::vector<core_buttons> inputs(freeze.length_samples + 1);
+        memread(&ptr, inputs.data(), inputs.size() * sizeof(core_buttons));
+        freeze.input_buffer = vcr_make_input_snapshot(inputs.data(), freeze.length_samples);
 
         const auto code = core_vcr_unfreeze(freeze);
 
@@ -468,7 +750,9 @@ void savestates_load_immediate_impl(const t_savestate_task& task)
 
         // so far loading success! overwrite memory
         load_eventqueue_infos(g_event_queue_buf);
-        load_memory_from_buffer(g_first_block);
+        load_memory_from_buffer(g_first_block, has_tlb_luts);
+        g_tlb_luts_buf.clear();
+        g_tlb_luts_buf.shrink_to_fit();
 
         // NOTE: We don't want to restore screen buffer while seeking, since it creates a int16_t ugly flicker when the movie restarts by loading state
         if (core_vr_get_mge_available() && video_buffer && !core_vcr_is_seeking())
@@ -673,8 +957,15 @@ void st_do_work()
     savestates_simplify_tasks();
     savestates_log_tasks();
 
-    for (const auto& task : g_tasks)
+    for (auto& task : g_tasks)
     {
+        const auto start_time = std::chrono::high_resolution_clock::now();
+        task.callback = [start_time, callback = task.callback](const core_st_callback_info& info, const std::vector<uint8_t>& buffer) {
+            auto timed_info = info;
+            timed_info.duration = std::chrono::high_resolution_clock::now() - start_time;
+            callback(timed_info, buffer);
+        };
+
         if (task.job == core_st_job_save)
         {
             savestates_save_immediate_impl(task);
@@ -692,9 +983,137 @@ void st_do_work()
 
 void st_on_core_stop()
 {
-    std::scoped_lock lock(g_task_mutex);
-    g_tasks.clear();
-    g_undo_savestate.clear();
+    {
+        std::scoped_lock lock(g_task_mutex);
+        g_tasks.clear();
+        g_undo_savestate.clear();
+    }
+
+    // NOTE: Write callbacks can enqueue more savestate work, which takes the task mutex, so we mustn't hold it while waiting.
+    savestates_wait_for_writes();
+
+    // The pooled buffers are ~11MB each, so they aren't kept around while no emulation is running
+    std::scoped_lock lock(g_buffer_pool_mutex);
+    g_buffer_pool.clear();
+    g_buffer_pool.shrink_to_fit();
+}
+
+std::vector<uint8_t> st_create_delta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& buffer)
+{
+    std::vector<uint8_t> delta;
+
+    uint32_t size = buffer.size();
+    vecwrite(delta, &size, sizeof(size));
+
+    for (uint32_t offset = 0; offset < buffer.size(); offset += ST_DELTA_PAGE_SIZE)
+    {
+        const uint32_t len = std::min<size_t>(ST_DELTA_PAGE_SIZE, buffer.size() - offset);
+
+        if (offset + len <= base.size() && memcmp(base.data() + offset, buffer.data() + offset, len) == 0)
+        {
+            continue;
+        }
+
+        uint32_t page = offset / ST_DELTA_PAGE_SIZE;
+        vecwrite(delta, &page, sizeof(page));
+        vecwrite(delta, (void*)(buffer.data() + offset), len);
+    }
+
+    return delta;
+}
+
+std::vector<uint8_t> st_apply_delta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& delta)
+{
+    if (delta.size() < sizeof(uint32_t))
+    {
+        return {};
+    }
+
+    uint8_t* ptr = (uint8_t*)delta.data();
+    const uint8_t* end = delta.data() + delta.size();
+
+    uint32_t size;
+    memread(&ptr, &size, sizeof(size));
+
+    std::vector<uint8_t> buffer(size);
+    memcpy(buffer.data(), base.data(), std::min<size_t>(size, base.size()));
+
+    while (ptr < end)
+    {
+        if (end - ptr < sizeof(uint32_t))
+        {
+            return {};
+        }
+
+        uint32_t page;
+        memread(&ptr, &page, sizeof(page));
+
+        const size_t offset = (size_t)page * ST_DELTA_PAGE_SIZE;
+        if (offset >= size)
+        {
+            return {};
+        }
+
+        const size_t len = std::min<size_t>(ST_DELTA_PAGE_SIZE, size - offset);
+        if (end - ptr < len)
+        {
+            return {};
+        }
+
+        memread(&ptr, buffer.data() + offset, len);
+    }
+
+    return buffer;
+}
+
+std::vector<uint8_t> st_compress(const core_st_codec codec, const std::vector<uint8_t>& buffer)
+{
+    switch (codec)
+    {
+    case core_st_codec_none:
+        return buffer;
+    case core_st_codec_deflate:
+        {
+            const auto compressor = libdeflate_alloc_compressor(1);
+
+            std::vector<uint8_t> compressed(libdeflate_deflate_compress_bound(compressor, buffer.size()));
+            const size_t final_size = libdeflate_deflate_compress(compressor, buffer.data(), buffer.size(), compressed.data(), compressed.size());
+            libdeflate_free_compressor(compressor);
+
+            compressed.resize(final_size);
+            compressed.shrink_to_fit();
+            return compressed;
+        }
+    default:
+        assert(false);
+        return {};
+    }
+}
+
+std::vector<uint8_t> st_decompress(const core_st_codec codec, const std::vector<uint8_t>& buffer, const size_t size)
+{
+    switch (codec)
+    {
+    case core_st_codec_none:
+        return buffer;
+    case core_st_codec_deflate:
+        {
+            const auto decompressor = libdeflate_alloc_decompressor();
+
+            std::vector<uint8_t> decompressed(size);
+            const auto result = libdeflate_deflate_decompress(decompressor, buffer.data(), buffer.size(), decompressed.data(), decompressed.size(), nullptr);
+            libdeflate_free_decompressor(decompressor);
+
+            if (result != LIBDEFLATE_SUCCESS)
+            {
+                return {};
+            }
+            return decompressed;
+        }
+    default:
+        assert(false);
+        return {};
+    }
 }
 
 /**
@@ -742,6 +1161,7 @@ bool core_st_do_file(const std::filesystem::path& path, const core_st_job job, c
     };
 
     g_tasks.insert(g_tasks.begin(), task);
+    emu_thread_notify();
     return true;
 }
 
@@ -781,6 +1201,7 @@ bool core_st_do_memory(const std::vector<uint8_t>& buffer, const core_st_job job
     };
 
     g_tasks.insert(g_tasks.begin(), task);
+    emu_thread_notify();
     return true;
 }
 
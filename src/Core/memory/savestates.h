@@ -21,3 +21,36 @@ void st_do_work();
  * Clears the work queue and the undo savestate.
  */
 void st_on_core_stop();
+
+/**
+ * \brief Encodes a savestate buffer as a set of page deltas against a base savestate buffer.
+ * \param base The base savestate buffer.
+ * \param buffer The savestate buffer to encode.
+ * \return The delta buffer, which contains the buffer's size followed by the index and contents of each page differing from the base.
+ */
+std::vector<uint8_t> st_create_delta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& buffer);
+
+/**
+ * \brief Reconstructs a savestate buffer from a base savestate buffer and a delta buffer created by <c>st_create_delta</c>.
+ * \param base The base savestate buffer the delta was created against.
+ * \param delta The delta buffer.
+ * \return The reconstructed savestate buffer, or an empty vector if the delta is malformed.
+ */
+std::vector<uint8_t> st_apply_delta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& delta);
+
+/**
+ * \brief Compresses an in-memory savestate buffer.
+ * \param codec The codec to use.
+ * \param buffer The buffer to compress.
+ * \return The compressed buffer, or an empty vector if the operation failed.
+ */
+std::vector<uint8_t> st_compress(core_st_codec codec, const std::vector<uint8_t>& buffer);
+
+/**
+ * \brief Decompresses an in-memory savestate buffer created by <c>st_compress</c>.
+ * \param codec The codec the buffer was compressed with.
+ * \param buffer The compressed buffer.
+ * \param size The buffer's uncompressed size.
+ * \return The decompressed buffer, or an empty vector if the operation failed.
+ */
+std::vector<uint8_t> st_decompress(core_st_codec codec, const std::vector<uint8_t>& buffer, size_t size);
@@ -18,9 +18,83 @@
 
 uint32_t tlb_LUT_r[0x100000];
 uint32_t tlb_LUT_w[0x100000];
+bool tlb_luts_diverged = false;
 extern uint32_t interp_addr;
 int32_t jump_marker = 0;
 
+void tlb_map(uint32_t* lut, uint32_t start, uint32_t end, uint32_t phys)
+{
+    // Each page holds the translation of the last address of the range that falls into it, which is what the old per-byte fill loops left behind.
+    // This loop is a linear ramp, so it gets vectorized for large page masks.
+    const uint32_t last_page = (end - 1) >> 12;
+    for (uint32_t page = start >> 12; page < last_page; page++)
+        lut[page] = 0x80000000 | (phys + (((page << 12) | 0xFFF) - start));
+    lut[last_page] = 0x80000000 | (phys + (end - 1 - start));
+}
+
+void tlb_unmap(uint32_t* lut, uint32_t start, uint32_t end)
+{
+    if (start >= end)
+        return;
+    std::fill(lut + (start >> 12), lut + ((end - 1) >> 12) + 1, 0);
+}
+
+/**
+ * Maps one half of a TLB entry into the lookup tables, if it's valid and doesn't cover the unmapped kernel segments.
+ */
+static void tlb_map_half(uint32_t start, uint32_t end, uint32_t phys, char v, char d)
+{
+    if (!v || start >= end || (start >= 0x80000000 && end < 0xC0000000) || phys >= 0x20000000)
+        return;
+
+    tlb_map(tlb_LUT_r, start, end, phys);
+    if (d)
+        tlb_map(tlb_LUT_w, start, end, phys);
+}
+
+/**
+ * Gets whether a valid half of a TLB entry covers any page of a valid half of another TLB entry.
+ */
+static bool tlb_half_overlaps_others(uint32_t start, uint32_t end, char v, size_t index)
+{
+    if (!v || start > end)
+        return false;
+
+    for (size_t i = 0; i < std::size(tlb_e); i++)
+    {
+        if (i == index)
+            continue;
+        if (tlb_e[i].v_even && tlb_e[i].start_even <= tlb_e[i].end_even && tlb_e[i].start_even >> 12 <= end >> 12 && tlb_e[i].end_even >> 12 >= start >> 12)
+            return true;
+        if (tlb_e[i].v_odd && tlb_e[i].start_odd <= tlb_e[i].end_odd && tlb_e[i].start_odd >> 12 <= end >> 12 && tlb_e[i].end_odd >> 12 >= start >> 12)
+            return true;
+    }
+    return false;
+}
+
+void tlb_on_entry_written(const tlb& old, size_t index)
+{
+    // A write clears the old entry's pages and maps the new entry over whatever is there, whereas tlb_rebuild_luts maps the entries in index order.
+    // Both only agree as long as no write touches pages which another entry maps.
+    if (tlb_half_overlaps_others(old.start_even, old.end_even, old.v_even, index) ||
+        tlb_half_overlaps_others(old.start_odd, old.end_odd, old.v_odd, index) ||
+        tlb_half_overlaps_others(tlb_e[index].start_even, tlb_e[index].end_even, tlb_e[index].v_even, index) ||
+        tlb_half_overlaps_others(tlb_e[index].start_odd, tlb_e[index].end_odd, tlb_e[index].v_odd, index))
+        tlb_luts_diverged = true;
+}
+
+void tlb_rebuild_luts()
+{
+    memset(tlb_LUT_r, 0, sizeof(tlb_LUT_r));
+    memset(tlb_LUT_w, 0, sizeof(tlb_LUT_w));
+
+    for (const auto& entry : tlb_e)
+    {
+        tlb_map_half(entry.start_even, entry.end_even, entry.phys_even, entry.v_even, entry.d_even);
+        tlb_map_half(entry.start_odd, entry.end_odd, entry.phys_odd, entry.v_odd, entry.d_odd);
+    }
+}
+
 uint32_t virtual_to_physical_address(uint32_t addresse, int32_t w)
 {
     if (addresse >= 0x7f000000 && addresse < 0x80000000) // golden eye hack (it uses TLB a lot)
@@ -91,6 +165,7 @@ void TLBR()
 void TLBWI()
 {
     uint32_t i;
+    const tlb old = tlb_e[core_Index & 0x3F];
 
     if (tlb_e[core_Index & 0x3F].v_even)
     {
@@ -161,13 +236,9 @@ void TLBWI()
               tlb_e[core_Index & 0x3F].end_even < 0xC0000000) &&
             tlb_e[core_Index & 0x3F].phys_even < 0x20000000)
         {
-            for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                (tlb_e[core_Index & 0x3F].phys_even + (i - tlb_e[core_Index & 0x3F].start_even));
+            tlb_map(tlb_LUT_r, tlb_e[core_Index & 0x3F].start_even, tlb_e[core_Index & 0x3F].end_even, tlb_e[core_Index & 0x3F].phys_even);
             if (tlb_e[core_Index & 0x3F].d_even)
-                for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Index & 0x3F].phys_even + (i - tlb_e[core_Index & 0x3F].start_even));
+                tlb_map(tlb_LUT_w, tlb_e[core_Index & 0x3F].start_even, tlb_e[core_Index & 0x3F].end_even, tlb_e[core_Index & 0x3F].phys_even);
         }
 
         for (i = tlb_e[core_Index & 0x3F].start_even >> 12; i <= tlb_e[core_Index & 0x3F].end_even >> 12; i++)
@@ -191,13 +262,9 @@ void TLBWI()
               tlb_e[core_Index & 0x3F].end_odd < 0xC0000000) &&
             tlb_e[core_Index & 0x3F].phys_odd < 0x20000000)
         {
-            for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                (tlb_e[core_Index & 0x3F].phys_odd + (i - tlb_e[core_Index & 0x3F].start_odd));
+            tlb_map(tlb_LUT_r, tlb_e[core_Index & 0x3F].start_odd, tlb_e[core_Index & 0x3F].end_odd, tlb_e[core_Index & 0x3F].phys_odd);
             if (tlb_e[core_Index & 0x3F].d_odd)
-                for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Index & 0x3F].phys_odd + (i - tlb_e[core_Index & 0x3F].start_odd));
+                tlb_map(tlb_LUT_w, tlb_e[core_Index & 0x3F].start_odd, tlb_e[core_Index & 0x3F].end_odd, tlb_e[core_Index & 0x3F].phys_odd);
         }
 
         for (i = tlb_e[core_Index & 0x3F].start_odd >> 12; i <= tlb_e[core_Index & 0x3F].end_odd >> 12; i++)
@@ -209,6 +276,7 @@ void TLBWI()
             }
         }
     }
+    tlb_on_entry_written(old, core_Index & 0x3F);
     PC++;
 }
 
@@ -217,6 +285,7 @@ void TLBWR()
     uint32_t i;
     update_count();
     core_Random = (core_Count / 2 % (32 - core_Wired)) + core_Wired;
+    const tlb old = tlb_e[core_Random];
 
     if (tlb_e[core_Random].v_even)
     {
@@ -286,13 +355,9 @@ void TLBWR()
               tlb_e[core_Random].end_even < 0xC0000000) &&
             tlb_e[core_Random].phys_even < 0x20000000)
         {
-            for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                (tlb_e[core_Random].phys_even + (i - tlb_e[core_Random].start_even));
+            tlb_map(tlb_LUT_r, tlb_e[core_Random].start_even, tlb_e[core_Random].end_even, tlb_e[core_Random].phys_even);
             if (tlb_e[core_Random].d_even)
-                for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Random].phys_even + (i - tlb_e[core_Random].start_even));
+                tlb_map(tlb_LUT_w, tlb_e[core_Random].start_even, tlb_e[core_Random].end_even, tlb_e[core_Random].phys_even);
         }
 
         for (i = tlb_e[core_Random].start_even >> 12; i <= tlb_e[core_Random].end_even >> 12; i++)
@@ -316,13 +381,9 @@ void TLBWR()
               tlb_e[core_Random].end_odd < 0xC0000000) &&
             tlb_e[core_Random].phys_odd < 0x20000000)
         {
-            for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                (tlb_e[core_Random].phys_odd + (i - tlb_e[core_Random].start_odd));
+            tlb_map(tlb_LUT_r, tlb_e[core_Random].start_odd, tlb_e[core_Random].end_odd, tlb_e[core_Random].phys_odd);
             if (tlb_e[core_Random].d_odd)
-                for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Random].phys_odd + (i - tlb_e[core_Random].start_odd));
+                tlb_map(tlb_LUT_w, tlb_e[core_Random].start_odd, tlb_e[core_Random].end_odd, tlb_e[core_Random].phys_odd);
         }
 
         for (i = tlb_e[core_Random].start_odd >> 12; i <= tlb_e[core_Random].end_odd >> 12; i++)
@@ -334,6 +395,7 @@ void TLBWR()
             }
         }
     }
+    tlb_on_entry_written(old, core_Random);
     PC++;
 }
 
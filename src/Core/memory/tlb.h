@@ -32,5 +32,39 @@ typedef struct _tlb {
 
 extern uint32_t tlb_LUT_r[0x100000];
 extern uint32_t tlb_LUT_w[0x100000];
+
+// Whether the lookup tables might differ from what tlb_rebuild_luts produces, because a TLB entry was written while it overlapped another one.
+// Savestates store the lookup tables while this is set.
+extern bool tlb_luts_diverged;
+
+/**
+ * \brief Maps a virtual address range to a physical address in a TLB lookup table.
+ * \param lut The lookup table.
+ * \param start The first virtual address of the range.
+ * \param end The virtual address one past the last address of the range. Must be greater than <c>start</c>.
+ * \param phys The physical address <c>start</c> maps to.
+ */
+void tlb_map(uint32_t* lut, uint32_t start, uint32_t end, uint32_t phys);
+
+/**
+ * \brief Unmaps a virtual address range in a TLB lookup table.
+ * \param lut The lookup table.
+ * \param start The first virtual address of the range.
+ * \param end The virtual address one past the last address of the range. Nothing is unmapped if it's not greater than <c>start</c>.
+ */
+void tlb_unmap(uint32_t* lut, uint32_t start, uint32_t end);
+
+/**
+ * \brief Updates the divergence tracking after a TLB entry was written. Must be called after the entry and the lookup tables were updated.
+ * \param old The entry's value before the write.
+ * \param index The entry's index.
+ */
+void tlb_on_entry_written(const tlb& old, size_t index);
+
+/**
+ * \brief Rebuilds both TLB lookup tables from the TLB entries.
+ */
+void tlb_rebuild_luts();
+
 uint32_t virtual_to_physical_address(uint32_t addresse, int32_t w);
 int32_t probe_nop(uint32_t address);
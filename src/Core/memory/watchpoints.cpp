@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <Core.h>
+#include <memory/memory.h>
+#include <memory/watchpoints.h>
+#include <r4300/r4300.h>
+
+// Read and write watches are implemented by replacing the memory handlers of the 64 KB regions they overlap with trapping handlers, which forward to the original handlers and then report the access.
+// All other regions keep their handlers, so only watched regions pay for the lookup.
+
+struct t_watch {
+    uint32_t id;
+    /// The first watched physical address.
+    uint32_t start;
+    /// The last watched physical address.
+    uint32_t end;
+    /// A combination of core_dbg_watch_kind flags.
+    uint32_t kinds;
+};
+
+/// The handlers a watched region had before the watch handlers were installed, indexed by access size (byte, halfword, word, doubleword).
+struct t_watch_region {
+    void (*read[4])();
+    void (*write[4])();
+};
+
+constexpr uint32_t WATCH_ACCESS_SIZES[4] = {1, 2, 4, 8};
+
+static void (**const g_read_tables[4])() = {readmemb, readmemh, readmem, readmemd};
+static void (**const g_write_tables[4])() = {writememb, writememh, writemem, writememd};
+
+uint8_t watch_exec_pages[0x20000];
+
+// Locked when accessing the watch list or the watched regions. Never held while invoking callbacks or the original handlers.
+static std::mutex g_watch_mutex;
+static std::vector<t_watch> g_watches;
+static std::map<uint16_t, t_watch_region> g_watch_regions;
+static uint32_t g_watch_next_id = 1;
+
+// The watches hit by the current access, only used on the emulation thread
+static std::vector<uint32_t> g_watch_hits;
+
+/**
+ * \brief Gets the program counter of the current instruction, or 0 under the dynamic recompiler, which only updates PC at block boundaries.
+ */
+static uint32_t get_pc()
+{
+    if (interpcore)
+    {
+        return interp_addr;
+    }
+    return dynacore ? 0 : PC->addr;
+}
+
+/**
+ * \brief Gets whether the active core, or the configured one if emulation isn't running, reports executed instructions.
+ */
+static bool exec_watches_supported()
+{
+    return core_executing ? interpcore : g_core->cfg->core_type == 2;
+}
+
+static void watch_notify(uint32_t addr, uint32_t size, core_dbg_watch_kind kind, uint64_t value)
+{
+    const uint32_t start = addr & 0x1FFFFFFF;
+    const uint32_t end = start + size - 1;
+
+    g_watch_hits.clear();
+    {
+        std::scoped_lock lock(g_watch_mutex);
+        for (const auto& watch : g_watches)
+        {
+            if (watch.kinds & kind && start <= watch.end && end >= watch.start)
+            {
+                g_watch_hits.push_back(watch.id);
+            }
+        }
+    }
+
+    for (const auto id : g_watch_hits)
+    {
+        core_dbg_watch_hit hit = {
+        .id = id,
+        .kind = kind,
+        .address = addr,
+        .size = size,
+        .value = value,
+        .pc = get_pc(),
+        };
+        g_core->callbacks.debugger_watch_hit(&hit);
+    }
+}
+
+template <size_t Index>
+static void watch_read()
+{
+    const uint32_t addr = address;
+    const auto region = (uint16_t)(addr >> 16);
+
+    // The region might have been uninstalled by another thread since this handler was dispatched, in which case the table already holds its original handler again
+    void (*original)();
+    {
+        std::scoped_lock lock(g_watch_mutex);
+        const auto it = g_watch_regions.find(region);
+        original = it != g_watch_regions.end() ? it->second.read[Index] : g_read_tables[Index][region];
+    }
+
+    if (original == watch_read<Index>)
+    {
+        original = read_nothing;
+    }
+
+    original();
+
+    const uint64_t mask = Index == 3 ? UINT64_MAX : (1ull << WATCH_ACCESS_SIZES[Index] * 8) - 1;
+    watch_notify(addr, WATCH_ACCESS_SIZES[Index], core_dbg_watch_read, *rdword & mask);
+}
+
+template <size_t Index>
+static void watch_write()
+{
+    const uint32_t addr = address;
+    const auto region = (uint16_t)(addr >> 16);
+
+    uint64_t value;
+    switch (Index)
+    {
+    case 0:
+        value = g_byte;
+        break;
+    case 1:
+        value = hword;
+        break;
+    case 2:
+        value = word;
+        break;
+    default:
+        value = dword;
+        break;
+    }
+
+    // The region might have been uninstalled by another thread since this handler was dispatched, in which case the table already holds its original handler again
+    void (*original)();
+    {
+        std::scoped_lock lock(g_watch_mutex);
+        const auto it = g_watch_regions.find(region);
+        original = it != g_watch_regions.end() ? it->second.write[Index] : g_write_tables[Index][region];
+    }
+
+    if (original == watch_write<Index>)
+    {
+        original = write_nothing;
+    }
+
+    original();
+
+    watch_notify(addr, WATCH_ACCESS_SIZES[Index], core_dbg_watch_write, value);
+}
+
+static void (*const g_watch_read_handlers[4])() = {watch_read<0>, watch_read<1>, watch_read<2>, watch_read<3>};
+static void (*const g_watch_write_handlers[4])() = {watch_write<0>, watch_write<1>, watch_write<2>, watch_write<3>};
+
+/**
+ * \brief Installs the watch handlers in a region, saving the current ones.
+ */
+static void install_region(uint16_t region)
+{
+    t_watch_region saved{};
+    for (size_t i = 0; i < 4; ++i)
+    {
+        saved.read[i] = g_read_tables[i][region];
+        saved.write[i] = g_write_tables[i][region];
+        g_read_tables[i][region] = g_watch_read_handlers[i];
+        g_write_tables[i][region] = g_watch_write_handlers[i];
+    }
+    g_watch_regions[region] = saved;
+}
+
+/**
+ * \brief Restores the saved handlers of a region. Handlers which were replaced since the watch handlers were installed are left alone.
+ */
+static void uninstall_region(uint16_t region, const t_watch_region& saved)
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        if (g_read_tables[i][region] == g_watch_read_handlers[i])
+        {
+            g_read_tables[i][region] = saved.read[i];
+        }
+        if (g_write_tables[i][region] == g_watch_write_handlers[i])
+        {
+            g_write_tables[i][region] = saved.write[i];
+        }
+    }
+}
+
+/**
+ * \brief Brings the handler tables and the execution page table in line with the watch list.
+ * \warning The watch mutex must be held.
+ */
+static void rebuild_watches()
+{
+    std::vector<uint16_t> regions;
+    memset(watch_exec_pages, 0, sizeof(watch_exec_pages));
+
+    for (const auto& watch : g_watches)
+    {
+        if (watch.kinds & (core_dbg_watch_read | core_dbg_watch_write))
+        {
+            // The KSEG0 and KSEG1 mirrors have their own table entries
+            for (uint32_t region = watch.start >> 16; region <= watch.end >> 16; ++region)
+            {
+                regions.push_back((uint16_t)(0x8000 | region));
+                regions.push_back((uint16_t)(0xa000 | region));
+            }
+        }
+
+        if (watch.kinds & core_dbg_watch_exec)
+        {
+            for (uint32_t page = watch.start >> 12; page <= watch.end >> 12; ++page)
+            {
+                watch_exec_pages[page] = 1;
+            }
+        }
+    }
+
+    std::ranges::sort(regions);
+    const auto [first, last] = std::ranges::unique(regions);
+    regions.erase(first, last);
+
+    std::erase_if(g_watch_regions, [&](const auto& pair) {
+        if (std::ranges::binary_search(regions, pair.first))
+        {
+            return false;
+        }
+        uninstall_region(pair.first, pair.second);
+        return true;
+    });
+
+    bool installed = false;
+    for (const auto region : regions)
+    {
+        if (!g_watch_regions.contains(region))
+        {
+            install_region(region);
+            installed = true;
+        }
+    }
+
+    // Code compiled with fast memory accesses bypasses the handler tables entirely
+    if (installed)
+    {
+        fast_memory = 0;
+        memset(invalid_code, 1, sizeof(invalid_code));
+    }
+}
+
+void watch_refresh_handlers()
+{
+    std::scoped_lock lock(g_watch_mutex);
+
+    if (g_watch_regions.empty())
+    {
+        return;
+    }
+
+    for (auto& [region, saved] : g_watch_regions)
+    {
+        for (size_t i = 0; i < 4; ++i)
+        {
+            if (g_read_tables[i][region] != g_watch_read_handlers[i])
+            {
+                saved.read[i] = g_read_tables[i][region];
+                g_read_tables[i][region] = g_watch_read_handlers[i];
+            }
+            if (g_write_tables[i][region] != g_watch_write_handlers[i])
+            {
+                saved.write[i] = g_write_tables[i][region];
+                g_write_tables[i][region] = g_watch_write_handlers[i];
+            }
+        }
+    }
+
+    fast_memory = 0;
+}
+
+void watch_on_exec(uint32_t addr)
+{
+    watch_notify(addr, 4, core_dbg_watch_exec, 0);
+}
+
+core_result core_dbg_add_watch(uint32_t address, uint32_t size, uint32_t kinds, uint32_t* id)
+{
+    const uint32_t start = address & 0x1FFFFFFF;
+
+    if (size == 0 || start + (uint64_t)size - 1 > 0x1FFFFFFF || kinds == 0 || kinds & ~(core_dbg_watch_read | core_dbg_watch_write | core_dbg_watch_exec))
+    {
+        return DBG_InvalidWatch;
+    }
+
+    if (kinds & core_dbg_watch_exec && !exec_watches_supported())
+    {
+        g_core->log_warn(L"[Watch] Execution watches are only supported by the pure interpreter");
+        return DBG_ExecWatchUnsupported;
+    }
+
+    std::scoped_lock lock(g_watch_mutex);
+
+    *id = g_watch_next_id++;
+    g_watches.push_back(t_watch{
+    .id = *id,
+    .start = start,
+    .end = start + size - 1,
+    .kinds = kinds,
+    });
+    rebuild_watches();
+
+    g_core->log_info(std::format(L"[Watch] Added watch {} over {:#010x}-{:#010x}", *id, start, start + size - 1));
+
+    return Res_Ok;
+}
+
+core_result core_dbg_remove_watch(uint32_t id)
+{
+    std::scoped_lock lock(g_watch_mutex);
+
+    if (!std::erase_if(g_watches, [=](const t_watch& watch) { return watch.id == id; }))
+    {
+        return DBG_WatchNotFound;
+    }
+    rebuild_watches();
+
+    g_core->log_info(std::format(L"[Watch] Removed watch {}", id));
+
+    return Res_Ok;
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+// For each 4 KB physical page, whether an execution watch overlaps it
+extern uint8_t watch_exec_pages[0x20000];
+
+/**
+ * \brief Reinstalls the watch handlers in all watched regions whose handlers were replaced since they were installed.
+ * The replacement handlers become the ones the watch handlers forward to.
+ * \remarks Must be called after the memory handler tables are modified, e.g. when protecting framebuffers.
+ */
+void watch_refresh_handlers();
+
+/**
+ * \brief Notifies the watch subsystem of an instruction being executed.
+ * \param addr The instruction's address.
+ */
+void watch_on_exec(uint32_t addr);
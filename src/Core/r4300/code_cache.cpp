@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <Core.h>
+#include <alloc.h>
+#include <r4300/code_cache.h>
+#include <r4300/r4300.h>
+#include <r4300/recomp.h>
+
+// The arena is split into two halves which are filled alternately. When the current half runs low, the cache switches to the other one and invalidates every block.
+// The code in the half we just left is kept intact for one more generation, since the emulation thread can still be executing or returning into it.
+
+constexpr size_t CODE_CACHE_ALIGNMENT = 16;
+constexpr size_t CODE_CACHE_COMMIT_SIZE = 1024 * 1024;
+constexpr size_t CODE_CACHE_MIN_SIZE = 8 * 1024 * 1024;
+
+// Space left free in the current half for the block being compiled to grow into
+constexpr size_t CODE_CACHE_HEADROOM = 1024 * 1024;
+
+struct t_code_cache_half {
+    uint8_t* base;
+    /// The amount of bytes handed out.
+    size_t used;
+    /// The amount of bytes committed, always a multiple of CODE_CACHE_COMMIT_SIZE.
+    size_t committed;
+};
+
+struct t_overflow_alloc {
+    size_t size;
+    uint64_t generation;
+};
+
+static uint8_t* g_arena;
+static size_t g_half_size;
+static t_code_cache_half g_halves[2];
+static size_t g_current;
+static uint64_t g_generation;
+
+// The most recent allocation in the current half, which can be grown in place
+static uint8_t* g_last_alloc;
+
+// Code allocated with malloc_exec because the arena couldn't hold it
+static std::map<void*, t_overflow_alloc> g_overflow;
+static size_t g_overflow_bytes;
+
+static std::atomic<size_t> g_stat_bytes_used;
+static std::atomic<size_t> g_stat_bytes_reserved;
+static std::atomic<uint64_t> g_stat_blocks_compiled;
+static std::atomic<uint64_t> g_stat_flushes;
+static std::atomic<int64_t> g_stat_compile_time;
+
+static void update_bytes_used()
+{
+    g_stat_bytes_used.store(g_halves[g_current].used + g_overflow_bytes, std::memory_order_relaxed);
+}
+
+static bool in_half(const t_code_cache_half& half, const void* ptr)
+{
+    return half.base && ptr >= half.base && ptr < half.base + g_half_size;
+}
+
+static void* overflow_alloc(size_t size)
+{
+    void* ptr = malloc_exec(size);
+    if (ptr)
+    {
+        g_overflow[ptr] = {size, g_generation};
+        g_overflow_bytes += size;
+    }
+    return ptr;
+}
+
+static void overflow_free(void* ptr)
+{
+    const auto it = g_overflow.find(ptr);
+    if (it == g_overflow.end())
+    {
+        return;
+    }
+    g_overflow_bytes -= it->second.size;
+    g_overflow.erase(it);
+    free_exec(ptr);
+}
+
+void code_cache_init()
+{
+    const size_t size = std::max((size_t)std::max(g_core->cfg->code_cache_size, 0) * 1024 * 1024, CODE_CACHE_MIN_SIZE);
+
+    g_half_size = size / 2 / CODE_CACHE_COMMIT_SIZE * CODE_CACHE_COMMIT_SIZE;
+    g_arena = (uint8_t*)reserve_exec(g_half_size * 2);
+    g_current = 0;
+    g_generation = 0;
+    g_last_alloc = nullptr;
+
+    if (!g_arena)
+    {
+        g_core->log_error(std::format(L"Failed to reserve {} MB for the code cache, falling back to per-block allocations", size / 1024 / 1024));
+        g_half_size = 0;
+    }
+
+    g_halves[0] = {g_arena, 0, 0};
+    g_halves[1] = {g_arena ? g_arena + g_half_size : nullptr, 0, 0};
+
+    g_stat_bytes_used = 0;
+    g_stat_bytes_reserved = g_half_size * 2;
+    g_stat_blocks_compiled = 0;
+    g_stat_flushes = 0;
+    g_stat_compile_time = 0;
+}
+
+void code_cache_destroy()
+{
+    for (const auto& [ptr, _] : g_overflow)
+    {
+        free_exec(ptr);
+    }
+    g_overflow.clear();
+    g_overflow_bytes = 0;
+
+    release_exec(g_arena, g_half_size * 2);
+    g_arena = nullptr;
+    g_halves[0] = {};
+    g_halves[1] = {};
+    g_last_alloc = nullptr;
+
+    g_stat_bytes_used = 0;
+    g_stat_bytes_reserved = 0;
+}
+
+void* code_cache_alloc(size_t size)
+{
+    auto& half = g_halves[g_current];
+    const size_t aligned_size = (size + CODE_CACHE_ALIGNMENT - 1) & ~(CODE_CACHE_ALIGNMENT - 1);
+
+    if (!half.base || half.used + aligned_size > g_half_size)
+    {
+        void* ptr = overflow_alloc(size);
+        update_bytes_used();
+        return ptr;
+    }
+
+    if (half.used + aligned_size > half.committed)
+    {
+        const size_t new_committed = std::min((half.used + aligned_size + CODE_CACHE_COMMIT_SIZE - 1) / CODE_CACHE_COMMIT_SIZE * CODE_CACHE_COMMIT_SIZE, g_half_size);
+        if (!commit_exec(half.base + half.committed, new_committed - half.committed))
+        {
+            void* ptr = overflow_alloc(size);
+            update_bytes_used();
+            return ptr;
+        }
+        half.committed = new_committed;
+    }
+
+    g_last_alloc = half.base + half.used;
+    half.used += aligned_size;
+    update_bytes_used();
+    return g_last_alloc;
+}
+
+void* code_cache_realloc(void* ptr, size_t old_size, size_t new_size)
+{
+    auto& half = g_halves[g_current];
+
+    if (ptr && ptr == g_last_alloc)
+    {
+        const size_t offset = (uint8_t*)ptr - half.base;
+        const size_t aligned_end = (offset + new_size + CODE_CACHE_ALIGNMENT - 1) & ~(CODE_CACHE_ALIGNMENT - 1);
+        const size_t new_committed = (aligned_end + CODE_CACHE_COMMIT_SIZE - 1) / CODE_CACHE_COMMIT_SIZE * CODE_CACHE_COMMIT_SIZE;
+
+        if (aligned_end <= g_half_size && (new_committed <= half.committed || commit_exec(half.base + half.committed, new_committed - half.committed)))
+        {
+            half.committed = std::max(half.committed, new_committed);
+            half.used = aligned_end;
+            update_bytes_used();
+            return ptr;
+        }
+    }
+
+    void* block = code_cache_alloc(new_size);
+    if (block && ptr)
+    {
+        memcpy(block, ptr, std::min(old_size, new_size));
+    }
+
+    // Moving out of the arena leaves the old region behind until the half is reused, but overflow allocations have no such grace period and are freed right away like realloc_exec does
+    overflow_free(ptr);
+    update_bytes_used();
+    return block;
+}
+
+bool code_cache_is_current(const void* ptr)
+{
+    if (in_half(g_halves[g_current], ptr))
+    {
+        return true;
+    }
+    if (in_half(g_halves[g_current ^ 1], ptr))
+    {
+        return false;
+    }
+    const auto it = g_overflow.find(const_cast<void*>(ptr));
+    return it != g_overflow.end() && it->second.generation == g_generation;
+}
+
+bool code_cache_needs_flush()
+{
+    return g_arena && g_halves[g_current].used + CODE_CACHE_HEADROOM > g_half_size;
+}
+
+void code_cache_flush()
+{
+    g_current ^= 1;
+    g_generation++;
+    g_halves[g_current].used = 0;
+    g_last_alloc = nullptr;
+
+    // Blocks whose code lives in the half we're about to overwrite or in expired overflow allocations lose it entirely, everything else is just invalidated
+    for (size_t i = 0; i < std::size(blocks); ++i)
+    {
+        invalid_code[i] = 1;
+
+        if (!blocks[i])
+        {
+            continue;
+        }
+
+        // Otherwise, TLBWI would revalidate the page if its contents haven't changed
+        blocks[i]->hash = 0;
+
+        if (!blocks[i]->code)
+        {
+            continue;
+        }
+
+        const auto it = g_overflow.find(blocks[i]->code);
+        const bool expired_overflow = it != g_overflow.end() && it->second.generation + 1 < g_generation;
+
+        if (in_half(g_halves[g_current], blocks[i]->code) || expired_overflow)
+        {
+            blocks[i]->code = nullptr;
+        }
+    }
+
+    std::erase_if(g_overflow, [](const auto& pair) {
+        if (pair.second.generation + 1 < g_generation)
+        {
+            g_overflow_bytes -= pair.second.size;
+            free_exec(pair.first);
+            return true;
+        }
+        return false;
+    });
+
+    update_bytes_used();
+    ++g_stat_flushes;
+
+    g_core->log_info(std::format(L"Code cache flushed (generation {})", g_generation));
+}
+
+void code_cache_on_block_compiled(std::chrono::nanoseconds time)
+{
+    g_stat_blocks_compiled.fetch_add(1, std::memory_order_relaxed);
+    g_stat_compile_time.fetch_add(time.count(), std::memory_order_relaxed);
+}
+
+core_code_cache_stats core_vr_get_code_cache_stats()
+{
+    return {
+    .bytes_used = g_stat_bytes_used.load(std::memory_order_relaxed),
+    .bytes_reserved = g_stat_bytes_reserved.load(std::memory_order_relaxed),
+    .blocks_compiled = g_stat_blocks_compiled.load(std::memory_order_relaxed),
+    .flushes = g_stat_flushes.load(std::memory_order_relaxed),
+    .compile_time = std::chrono::nanoseconds(g_stat_compile_time.load(std::memory_order_relaxed)),
+    };
+}
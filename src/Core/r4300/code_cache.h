@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+/**
+ * \brief Reserves the executable arena used by the dynamic recompiler.
+ * \remarks If the arena can't be reserved, all code is allocated separately with <c>malloc_exec</c> and the cache is never flushed.
+ */
+void code_cache_init();
+
+/**
+ * \brief Releases the executable arena and all code allocated from the cache.
+ */
+void code_cache_destroy();
+
+/**
+ * \brief Allocates a buffer for compiled code.
+ * \param size The buffer's size in bytes.
+ * \return The buffer, or nullptr if the operation failed.
+ */
+void* code_cache_alloc(size_t size);
+
+/**
+ * \brief Grows a buffer allocated with <c>code_cache_alloc</c>, in place if possible.
+ * \param ptr The buffer to grow.
+ * \param old_size The buffer's current size in bytes.
+ * \param new_size The buffer's new size in bytes.
+ * \return The grown buffer, or nullptr if the operation failed.
+ * \remarks If the buffer is moved, its old contents stay mapped until the cache is flushed twice, as the emulation thread may still be executing them.
+ */
+void* code_cache_realloc(void* ptr, size_t old_size, size_t new_size);
+
+/**
+ * \brief Gets whether a buffer belongs to the current cache generation, meaning it survived all flushes since its allocation.
+ */
+bool code_cache_is_current(const void* ptr);
+
+/**
+ * \brief Gets whether the current generation is close enough to its size limit that the cache should be flushed before compiling another block.
+ */
+bool code_cache_needs_flush();
+
+/**
+ * \brief Starts a new cache generation and invalidates all blocks, causing them to be recompiled into the new generation on their next use.
+ * \warning This function must only be called from the emulation thread while no block is being compiled.
+ */
+void code_cache_flush();
+
+/**
+ * \brief Records a block (re)compilation in the cache statistics.
+ * \param time The time spent compiling.
+ */
+void code_cache_on_block_compiled(std::chrono::nanoseconds time);
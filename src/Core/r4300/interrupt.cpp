@@ -16,102 +16,112 @@
 #include <r4300/vcr.h>
 #include <r4300/timers.h>
 #include <memory/pif.h>
+#include <memory/savefile.h>
 
-typedef struct _interrupt_queue {
+typedef struct _interrupt_event {
     int32_t type;
     uint32_t count;
-    struct _interrupt_queue* next;
-} interrupt_queue;
+} interrupt_event;
 
-static interrupt_queue* q = NULL;
+// Maximum number of events that can be queued at once, must be a power of two
+#define INTERRUPT_QUEUE_CAPACITY 128
 
-interrupt_queue g_pool[128]{};
-uint8_t g_pool_used[sizeof(g_pool)]{};
-size_t g_known_unused_index = SIZE_MAX;
+// The pending events, stored as a ring buffer sorted by the order they'll fire in
+static interrupt_event g_queue[INTERRUPT_QUEUE_CAPACITY]{};
+
+// The ring buffer index of the queue's head (the next event to fire)
+static size_t g_queue_head = 0;
+
+// The number of events in the queue
+static size_t g_queue_size = 0;
+
+/**
+ * Gets the event at the specified position in the queue, where 0 is the head.
+ */
+static interrupt_event& queue_at(size_t index)
+{
+    return g_queue[(g_queue_head + index) & (INTERRUPT_QUEUE_CAPACITY - 1)];
+}
 
 /**
- * Allocates an item in the interrupt pool.
+ * Gets the event at the head of the queue, or nullptr if the queue is empty.
  */
-interrupt_queue* pool_alloc()
+static interrupt_event* queue_head()
 {
-    size_t unused_index = SIZE_MAX;
+    return g_queue_size ? &queue_at(0) : nullptr;
+}
 
-    // OPTIMIZATION: If we know that there is an unused index, use it
-    if (g_known_unused_index != SIZE_MAX)
+/**
+ * Inserts an event at the specified position, moving whichever side of the queue is shorter by one slot.
+ */
+static void queue_insert(size_t index, int32_t type, uint32_t count)
+{
+    assert(g_queue_size < INTERRUPT_QUEUE_CAPACITY);
+    assert(index <= g_queue_size);
+
+    if (index < g_queue_size / 2)
     {
-        unused_index = g_known_unused_index;
+        g_queue_head = (g_queue_head - 1) & (INTERRUPT_QUEUE_CAPACITY - 1);
+        for (size_t i = 0; i < index; ++i)
+            queue_at(i) = queue_at(i + 1);
     }
     else
     {
-        for (int32_t i = 0; i < sizeof(g_pool); ++i)
-        {
-            if (g_pool_used[i] == false)
-            {
-                unused_index = i;
-                break;
-            }
-        }
-        assert(unused_index != SIZE_MAX);
+        for (size_t i = g_queue_size; i > index; --i)
+            queue_at(i) = queue_at(i - 1);
     }
 
-    g_pool_used[unused_index] = true;
-    g_known_unused_index = SIZE_MAX;
-
-    return &g_pool[unused_index];
+    queue_at(index) = {type, count};
+    ++g_queue_size;
 }
 
 /**
- * Frees an interrupt from the pool, allowing it to be reused.
+ * Erases the event at the specified position, moving whichever side of the queue is shorter by one slot.
  */
-void pool_free(const interrupt_queue* ptr)
+static void queue_erase(size_t index)
 {
-    const auto index_in_pool = ptr - (interrupt_queue*)&g_pool;
+    assert(index < g_queue_size);
 
-#ifdef _DEBUG
-    size_t index = SIZE_MAX;
-    for (int32_t i = 0; i < sizeof(g_pool); ++i)
+    if (index < g_queue_size / 2)
     {
-        if (&g_pool[i] == ptr)
-        {
-            index = i;
-            break;
-        }
+        for (size_t i = index; i > 0; --i)
+            queue_at(i) = queue_at(i - 1);
+        g_queue_head = (g_queue_head + 1) & (INTERRUPT_QUEUE_CAPACITY - 1);
+    }
+    else
+    {
+        for (size_t i = index; i < g_queue_size - 1; ++i)
+            queue_at(i) = queue_at(i + 1);
     }
 
-    assert(index != SIZE_MAX);
-    assert(index == index_in_pool);
-#endif
-
-    g_pool_used[index_in_pool] = false;
-    g_known_unused_index = index_in_pool;
+    --g_queue_size;
 }
 
 /**
- * Clears the pool.
+ * Finds the position of the first event with the specified type, or SIZE_MAX if no such event is queued.
  */
-void pool_clear()
+static size_t queue_find(int32_t type)
 {
-    memset(g_pool_used, 0, std::size(g_pool_used));
-    g_known_unused_index = SIZE_MAX;
+    for (size_t i = 0; i < g_queue_size; ++i)
+    {
+        if (queue_at(i).type == type)
+            return i;
+    }
+    return SIZE_MAX;
 }
 
 void clear_queue()
 {
-    while (q != NULL)
-    {
-        interrupt_queue* aux = q->next;
-        q = aux;
-    }
-    pool_clear();
+    g_queue_head = 0;
+    g_queue_size = 0;
 }
 
 void print_queue()
 {
-    interrupt_queue* aux;
     g_core->log_info(std::format(L"------------------ {:#06x}", core_Count));
-    aux = q;
-    while (aux != NULL)
+    for (size_t i = 0; i < g_queue_size; ++i)
     {
+        const interrupt_event* aux = &queue_at(i);
         std::wstring type = L"";
         switch (aux->type)
         {
@@ -147,7 +157,6 @@ void print_queue()
             break;
         }
         g_core->log_info(std::format(L"@{:#06x} {}", aux->count, type));
-        aux = aux->next;
     }
     g_core->log_info(L"------------------");
 }
@@ -216,7 +225,6 @@ void add_interrupt_event(int32_t type, uint32_t delay)
         g_core->log_info(std::format(L"two events of type {:#06x} in queue", type));
         print_queue();
     }
-    interrupt_queue* aux = q;
 
     // if (type == PI_INT)
     //{
@@ -224,53 +232,17 @@ void add_interrupt_event(int32_t type, uint32_t delay)
     // count = Count + delay/**2*/;
     // }
 
-    if (q == NULL)
-    {
-        q = pool_alloc();
-        q->next = NULL;
-        q->count = count;
-        q->type = type;
-        next_interrupt = q->count;
-        // print_queue();
-        return;
-    }
-
     // finds place in queue to insert the interrupt ( its sorted )
-    if (before_event(count, q->count, q->type) && !special)
-    {
-        q = pool_alloc();
-        q->next = aux;
-        q->count = count;
-        q->type = type;
-        next_interrupt = q->count;
-        // print_queue();
-        return;
-    }
+    // special events always go to the tail, other events go right before the first event they'll fire before
+    size_t index = 0;
+    while (index < g_queue_size && (!before_event(count, queue_at(index).count, queue_at(index).type) || special))
+        ++index;
 
-    while (aux->next != NULL && (!before_event(count, aux->next->count, aux->next->type) || special))
-        aux = aux->next;
+    queue_insert(index, type, count);
+
+    if (index == 0)
+        next_interrupt = count;
 
-    if (aux->next == NULL)
-    {
-        aux->next = pool_alloc();
-        aux = aux->next;
-        aux->next = NULL;
-        aux->count = count;
-        aux->type = type;
-    }
-    else
-    {
-        interrupt_queue* aux2;
-        if (type != SPECIAL_INT)
-            while (aux->next != NULL && aux->next->count == count)
-                aux = aux->next;
-        aux2 = aux->next;
-        aux->next = pool_alloc();
-        aux = aux->next;
-        aux->next = aux2;
-        aux->count = count;
-        aux->type = type;
-    }
     /*if (q->count > Count || (Count - q->count) < 0x80000000)
       next_interrupt = q->count;
     else
@@ -291,13 +263,13 @@ void add_interrupt_event_count(int32_t type, uint32_t count)
 
 void remove_interrupt_event()
 {
-    interrupt_queue* aux = q->next;
-    if (q->type == SPECIAL_INT)
+    if (queue_head()->type == SPECIAL_INT)
         SPECIAL_done = 1;
-    pool_free(q);
-    q = aux;
-    if (q != NULL && (q->count > core_Count || (core_Count - q->count) < 0x80000000))
-        next_interrupt = q->count;
+    g_queue_head = (g_queue_head + 1) & (INTERRUPT_QUEUE_CAPACITY - 1);
+    --g_queue_size;
+    const interrupt_event* head = queue_head();
+    if (head != nullptr && (head->count > core_Count || (core_Count - head->count) < 0x80000000))
+        next_interrupt = head->count;
     else
         next_interrupt = 0;
 }
@@ -309,16 +281,10 @@ void remove_interrupt_event()
 /// <returns></returns>
 uint32_t get_event(int32_t type)
 {
-    interrupt_queue* aux = q;
-    if (q == NULL)
+    const size_t index = queue_find(type);
+    if (index == SIZE_MAX)
         return 0;
-    if (q->type == type)
-        return q->count;
-    while (aux->next != NULL && aux->next->type != type)
-        aux = aux->next;
-    if (aux->next != NULL)
-        return aux->next->count;
-    return 0;
+    return queue_at(index).count;
 }
 
 /// <summary>
@@ -327,36 +293,19 @@ uint32_t get_event(int32_t type)
 /// <param name="type">interrupt type to find</param>
 void remove_event(int32_t type)
 {
-    interrupt_queue* aux = q;
-    if (q == NULL)
+    const size_t index = queue_find(type);
+    if (index == SIZE_MAX)
         return;
-    if (q->type == type)
-    {
-        aux = aux->next;
-        pool_free(q);
-        q = aux;
-        return;
-    }
-    while (aux->next != NULL && aux->next->type != type)
-        aux = aux->next;
-    if (aux->next != NULL) // it's a type int32_t
-    {
-        interrupt_queue* aux2 = aux->next->next;
-        pool_free(aux->next);
-        aux->next = aux2;
-    }
+    queue_erase(index);
 }
 
 void translate_event_queue(uint32_t base)
 {
-    interrupt_queue* aux;
     remove_event(COMPARE_INT);
     remove_event(SPECIAL_INT);
-    aux = q;
-    while (aux != NULL)
+    for (size_t i = 0; i < g_queue_size; ++i)
     {
-        aux->count = (aux->count - core_Count) + base;
-        aux = aux->next;
+        queue_at(i).count = (queue_at(i).count - core_Count) + base;
     }
     add_interrupt_event_count(COMPARE_INT, core_Compare);
     add_interrupt_event_count(SPECIAL_INT, 0);
@@ -371,18 +320,11 @@ int32_t save_eventqueue_infos(char* buf)
         g_core->log_info(L"SI_INT not found");
 #endif
     int32_t len = 0;
-    interrupt_queue* aux = q;
-    if (q == NULL)
-    {
-        *((uint32_t*)&buf[0]) = 0xFFFFFFFF;
-        return 4;
-    }
-    while (aux != NULL)
+    for (size_t i = 0; i < g_queue_size; ++i)
     {
-        memcpy(buf + len, &aux->type, 4);
-        memcpy(buf + len + 4, &aux->count, 4);
+        memcpy(buf + len, &queue_at(i).type, 4);
+        memcpy(buf + len + 4, &queue_at(i).count, 4);
         len += 8;
-        aux = aux->next;
     }
     *((uint32_t*)&buf[len]) = 0xFFFFFFFF;
     return len + 4;
@@ -428,21 +370,7 @@ void check_interrupt()
     // (which does nothing itself but makes cpu jump to general exception vector)
     if (core_Status & core_Cause & 0xFF00)
     {
-        if (q == NULL)
-        {
-            q = pool_alloc();
-            q->next = NULL;
-            q->count = core_Count;
-            q->type = CHECK_INT;
-        }
-        else
-        {
-            interrupt_queue* aux = pool_alloc();
-            aux->next = q;
-            aux->count = core_Count;
-            aux->type = CHECK_INT;
-            q = aux;
-        }
+        queue_insert(0, CHECK_INT, core_Count);
         next_interrupt = core_Count;
     }
 }
@@ -455,10 +383,12 @@ void gen_interrupt()
         dyna_stop();
     }
 
+    const interrupt_event* head = queue_head();
+
     if (skip_jump)
     {
-        if (q->count > core_Count || (core_Count - q->count) < 0x80000000)
-            next_interrupt = q->count;
+        if (head->count > core_Count || (core_Count - head->count) < 0x80000000)
+            next_interrupt = head->count;
         else
             next_interrupt = 0;
         if (interpcore)
@@ -476,8 +406,8 @@ void gen_interrupt()
         skip_jump = 0;
         return;
     }
-    auto type = q->type;
-    switch (q->type)
+    auto type = head->type;
+    switch (type)
     {
     case SPECIAL_INT:
         if (core_Count > 0x10000000)
@@ -505,6 +435,8 @@ void gen_interrupt()
 
             vcr_on_vi();
 
+            savefile_on_vi();
+
             timer_new_vi();
 
             if (vi_register.vi_v_sync == 0)
@@ -526,7 +458,7 @@ void gen_interrupt()
             break;
         }
     case COMPARE_INT: // game can set Compare register to some value, and make a timer like that
-        // g_core->log_info(L"COMPARE, count: {:#06x}", q->count);
+        // g_core->log_info(L"COMPARE, count: {:#06x}", head->count);
         remove_interrupt_event();
         core_Count += 2;
         add_interrupt_event_count(COMPARE_INT, core_Compare);
@@ -534,14 +466,14 @@ void gen_interrupt()
         break;
 
     case CHECK_INT: // fake interrupt used to trigger exception handler (when interrupt is pending)
-        // g_core->log_info(L"CHECK, count: {:#06x}", q->count);
+        // g_core->log_info(L"CHECK, count: {:#06x}", head->count);
         remove_interrupt_event();
         break;
 
     // serial interface, means that PIF copy/write happened (controllers)
     // notice this is spammed a lot during loading
     case SI_INT:
-        // g_core->log_info(L"SI, count: {:#06x}", q->count);
+        // g_core->log_info(L"SI, count: {:#06x}", head->count);
         PIF_RAMb[0x3F] = 0x0;
         remove_interrupt_event();
         MI_register.mi_intr_reg |= 0x02;
@@ -550,14 +482,14 @@ void gen_interrupt()
 
     // peripherial interface, dma between cartridge and rdram finished
     case PI_INT:
-        // g_core->log_info(L"PI, count: {:#06x}", q->count);
+        // g_core->log_info(L"PI, count: {:#06x}", head->count);
         remove_interrupt_event();
         MI_register.mi_intr_reg |= 0x10;
         pi_register.read_pi_status_reg &= ~3; // PI_STATUS_DMA_BUSY | PI_STATUS_IO_BUSY clear
         break;
 
     case AI_INT:
-        // g_core->log_info(L"AI, count: {:#06x}", q->count);
+        // g_core->log_info(L"AI, count: {:#06x}", head->count);
         if (ai_register.ai_status & 0x80000000) // full
         {
             uint32_t ai_event = get_event(AI_INT);
@@ -580,10 +512,11 @@ void gen_interrupt()
             MI_register.mi_intr_reg |= 0x04; // this too
             // return;
         }
+        audio_thread_notify();
         break;
 
     case SP_INT: // related to rsp
-        // g_core->log_info(L"SP, count: {:#06x}", q->count);
+        // g_core->log_info(L"SP, count: {:#06x}", head->count);
         remove_interrupt_event();
         sp_register.sp_status_reg |= 0x303;
         // sp_register.signal1 = 1;
@@ -597,7 +530,7 @@ void gen_interrupt()
         break;
 
     case DP_INT:
-        // g_core->log_info(L"DP, count: {:#06x}", q->count);
+        // g_core->log_info(L"DP, count: {:#06x}", head->count);
         remove_interrupt_event();
         dpc_register.dpc_status &= ~2;
         dpc_register.dpc_status |= 0x81;
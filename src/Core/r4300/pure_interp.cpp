@@ -9,6 +9,7 @@
 #include <include/core_api.h>
 #include <memory/memory.h>
 #include <memory/tlb.h>
+#include <memory/watchpoints.h>
 #include <r4300/cop1_helpers.h>
 #include <r4300/debugger.h>
 #include <r4300/exception.h>
@@ -22,6 +23,9 @@ uint32_t interp_addr;
 uint32_t vr_op;
 static int32_t skip;
 
+// The handler of the instruction last fetched by prefetch
+static void (*fetched_ops)();
+
 void prefetch();
 
 extern void (*interp_ops[])(void);
@@ -82,7 +86,7 @@ static void JR()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     interp_addr = local_rs32;
@@ -98,7 +102,7 @@ static void JALR()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     if (!skip_jump)
@@ -484,7 +488,7 @@ static void BLTZ()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     if (local_rs < 0)
@@ -515,7 +519,7 @@ static void BGEZ()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     if (local_rs >= 0)
@@ -548,7 +552,7 @@ static void BLTZL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        fetched_ops();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -583,7 +587,7 @@ static void BGEZL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        fetched_ops();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -619,7 +623,7 @@ static void BLTZAL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        fetched_ops();
         update_count();
         delay_slot = 0;
         if (local_rs < 0)
@@ -656,7 +660,7 @@ static void BGEZAL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        fetched_ops();
         update_count();
         delay_slot = 0;
         if (local_rs >= 0)
@@ -695,7 +699,7 @@ static void BLTZALL()
             interp_addr += 4;
             delay_slot = 1;
             prefetch();
-            interp_ops[((vr_op >> 26) & 0x3F)]();
+            fetched_ops();
             update_count();
             delay_slot = 0;
             interp_addr += (local_immediate - 1) * 4;
@@ -736,7 +740,7 @@ static void BGEZALL()
             interp_addr += 4;
             delay_slot = 1;
             prefetch();
-            interp_ops[((vr_op >> 26) & 0x3F)]();
+            fetched_ops();
             update_count();
             delay_slot = 0;
             interp_addr += (local_immediate - 1) * 4;
@@ -768,23 +772,18 @@ static void TLBR()
 
 static void TLBWI()
 {
-    uint32_t i;
-
+    const tlb old = tlb_e[core_Index & 0x3F];
     if (tlb_e[core_Index & 0x3F].v_even)
     {
-        for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-            tlb_LUT_r[i >> 12] = 0;
+        tlb_unmap(tlb_LUT_r, tlb_e[core_Index & 0x3F].start_even, tlb_e[core_Index & 0x3F].end_even);
         if (tlb_e[core_Index & 0x3F].d_even)
-            for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-                tlb_LUT_w[i >> 12] = 0;
+            tlb_unmap(tlb_LUT_w, tlb_e[core_Index & 0x3F].start_even, tlb_e[core_Index & 0x3F].end_even);
     }
     if (tlb_e[core_Index & 0x3F].v_odd)
     {
-        for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-            tlb_LUT_r[i >> 12] = 0;
+        tlb_unmap(tlb_LUT_r, tlb_e[core_Index & 0x3F].start_odd, tlb_e[core_Index & 0x3F].end_odd);
         if (tlb_e[core_Index & 0x3F].d_odd)
-            for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-                tlb_LUT_w[i >> 12] = 0;
+            tlb_unmap(tlb_LUT_w, tlb_e[core_Index & 0x3F].start_odd, tlb_e[core_Index & 0x3F].end_odd);
     }
     tlb_e[core_Index & 0x3F].g = (core_EntryLo0 & core_EntryLo1 & 1);
     tlb_e[core_Index & 0x3F].pfn_even = (core_EntryLo0 & 0x3FFFFFC0) >> 6;
@@ -812,13 +811,9 @@ static void TLBWI()
               tlb_e[core_Index & 0x3F].end_even < 0xC0000000) &&
             tlb_e[core_Index & 0x3F].phys_even < 0x20000000)
         {
-            for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                (tlb_e[core_Index & 0x3F].phys_even + (i - tlb_e[core_Index & 0x3F].start_even));
+            tlb_map(tlb_LUT_r, tlb_e[core_Index & 0x3F].start_even, tlb_e[core_Index & 0x3F].end_even, tlb_e[core_Index & 0x3F].phys_even);
             if (tlb_e[core_Index & 0x3F].d_even)
-                for (i = tlb_e[core_Index & 0x3F].start_even; i < tlb_e[core_Index & 0x3F].end_even; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Index & 0x3F].phys_even + (i - tlb_e[core_Index & 0x3F].start_even));
+                tlb_map(tlb_LUT_w, tlb_e[core_Index & 0x3F].start_even, tlb_e[core_Index & 0x3F].end_even, tlb_e[core_Index & 0x3F].phys_even);
         }
     }
 
@@ -834,38 +829,31 @@ static void TLBWI()
               tlb_e[core_Index & 0x3F].end_odd < 0xC0000000) &&
             tlb_e[core_Index & 0x3F].phys_odd < 0x20000000)
         {
-            for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                (tlb_e[core_Index & 0x3F].phys_odd + (i - tlb_e[core_Index & 0x3F].start_odd));
+            tlb_map(tlb_LUT_r, tlb_e[core_Index & 0x3F].start_odd, tlb_e[core_Index & 0x3F].end_odd, tlb_e[core_Index & 0x3F].phys_odd);
             if (tlb_e[core_Index & 0x3F].d_odd)
-                for (i = tlb_e[core_Index & 0x3F].start_odd; i < tlb_e[core_Index & 0x3F].end_odd; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Index & 0x3F].phys_odd + (i - tlb_e[core_Index & 0x3F].start_odd));
+                tlb_map(tlb_LUT_w, tlb_e[core_Index & 0x3F].start_odd, tlb_e[core_Index & 0x3F].end_odd, tlb_e[core_Index & 0x3F].phys_odd);
         }
     }
+    tlb_on_entry_written(old, core_Index & 0x3F);
     interp_addr += 4;
 }
 
 static void TLBWR()
 {
-    uint32_t i;
     update_count();
     core_Random = (core_Count / 2 % (32 - core_Wired)) + core_Wired;
+    const tlb old = tlb_e[core_Random];
     if (tlb_e[core_Random].v_even)
     {
-        for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-            tlb_LUT_r[i >> 12] = 0;
+        tlb_unmap(tlb_LUT_r, tlb_e[core_Random].start_even, tlb_e[core_Random].end_even);
         if (tlb_e[core_Random].d_even)
-            for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-                tlb_LUT_w[i >> 12] = 0;
+            tlb_unmap(tlb_LUT_w, tlb_e[core_Random].start_even, tlb_e[core_Random].end_even);
     }
     if (tlb_e[core_Random].v_odd)
     {
-        for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-            tlb_LUT_r[i >> 12] = 0;
+        tlb_unmap(tlb_LUT_r, tlb_e[core_Random].start_odd, tlb_e[core_Random].end_odd);
         if (tlb_e[core_Random].d_odd)
-            for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-                tlb_LUT_w[i >> 12] = 0;
+            tlb_unmap(tlb_LUT_w, tlb_e[core_Random].start_odd, tlb_e[core_Random].end_odd);
     }
     tlb_e[core_Random].g = (core_EntryLo0 & core_EntryLo1 & 1);
     tlb_e[core_Random].pfn_even = (core_EntryLo0 & 0x3FFFFFC0) >> 6;
@@ -893,13 +881,9 @@ static void TLBWR()
               tlb_e[core_Random].end_even < 0xC0000000) &&
             tlb_e[core_Random].phys_even < 0x20000000)
         {
-            for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                (tlb_e[core_Random].phys_even + (i - tlb_e[core_Random].start_even));
+            tlb_map(tlb_LUT_r, tlb_e[core_Random].start_even, tlb_e[core_Random].end_even, tlb_e[core_Random].phys_even);
             if (tlb_e[core_Random].d_even)
-                for (i = tlb_e[core_Random].start_even; i < tlb_e[core_Random].end_even; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Random].phys_even + (i - tlb_e[core_Random].start_even));
+                tlb_map(tlb_LUT_w, tlb_e[core_Random].start_even, tlb_e[core_Random].end_even, tlb_e[core_Random].phys_even);
         }
     }
     tlb_e[core_Random].start_odd = tlb_e[core_Random].end_even + 1;
@@ -914,15 +898,12 @@ static void TLBWR()
               tlb_e[core_Random].end_odd < 0xC0000000) &&
             tlb_e[core_Random].phys_odd < 0x20000000)
         {
-            for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-                tlb_LUT_r[i >> 12] = 0x80000000 |
-                (tlb_e[core_Random].phys_odd + (i - tlb_e[core_Random].start_odd));
+            tlb_map(tlb_LUT_r, tlb_e[core_Random].start_odd, tlb_e[core_Random].end_odd, tlb_e[core_Random].phys_odd);
             if (tlb_e[core_Random].d_odd)
-                for (i = tlb_e[core_Random].start_odd; i < tlb_e[core_Random].end_odd; i++)
-                    tlb_LUT_w[i >> 12] = 0x80000000 |
-                    (tlb_e[core_Random].phys_odd + (i - tlb_e[core_Random].start_odd));
+                tlb_map(tlb_LUT_w, tlb_e[core_Random].start_odd, tlb_e[core_Random].end_odd, tlb_e[core_Random].phys_odd);
         }
     }
+    tlb_on_entry_written(old, core_Random);
     interp_addr += 4;
 }
 
@@ -1142,7 +1123,7 @@ static void BC1F()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     if ((FCR31 & 0x800000) == 0)
@@ -1172,7 +1153,7 @@ static void BC1T()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     if ((FCR31 & 0x800000) != 0)
@@ -1204,7 +1185,7 @@ static void BC1FL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        fetched_ops();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -1238,7 +1219,7 @@ static void BC1TL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        fetched_ops();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -2186,7 +2167,7 @@ static void J()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     interp_addr = naddr;
@@ -2205,7 +2186,7 @@ static void JAL()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     if (!skip_jump)
@@ -2232,7 +2213,7 @@ static void BEQ()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     if (local_rs == local_rt && !g_vr_beq_ignore_jmp)
@@ -2254,7 +2235,7 @@ static void BNE()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     if (local_rs != local_rt)
@@ -2275,7 +2256,7 @@ static void BLEZ()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     if (local_rs <= 0)
@@ -2296,7 +2277,7 @@ static void BGTZ()
     interp_addr += 4;
     delay_slot = 1;
     prefetch();
-    interp_ops[((vr_op >> 26) & 0x3F)]();
+    fetched_ops();
     update_count();
     delay_slot = 0;
     if (local_rs > 0)
@@ -2401,7 +2382,7 @@ static void BEQL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        fetched_ops();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -2440,7 +2421,7 @@ static void BNEL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        fetched_ops();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -2478,7 +2459,7 @@ static void BLEZL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        fetched_ops();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -2516,7 +2497,7 @@ static void BGTZL()
         interp_addr += 4;
         delay_slot = 1;
         prefetch();
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        fetched_ops();
         update_count();
         delay_slot = 0;
         interp_addr += (local_immediate - 1) * 4;
@@ -3083,6 +3064,69 @@ void (*interp_ops[64])(void) =
 {
 SPECIAL, REGIMM, J, JAL, BEQ, BNE, BLEZ, BGTZ, ADDI, ADDIU, SLTI, SLTIU, ANDI, ORI, XORI, LUI, COP0, COP1, NI, NI, BEQL, BNEL, BLEZL, BGTZL, DADDI, DADDIU, LDL, LDR, NI, NI, NI, NI, LB, LH, LWL, LW, LBU, LHU, LWR, LWU, SB, SH, SWL, SW, SDL, SDR, SWR, CACHE, LL, LWC1, NI, NI, NI, LDC1, NI, LD, SC, SWC1, NI, NI, NI, SDC1, NI, SD};
 
+/**
+ * \brief An instruction decoded by <c>prefetch_opcode</c>.
+ */
+struct t_decoded_instr {
+    /// The opcode the entry was decoded from. The entry is only reused while memory still holds the same opcode.
+    uint32_t op;
+    /// The instruction's handler, resolved through the SPECIAL, REGIMM and COP0 tables. Null if the entry is empty.
+    void (*ops)();
+    /// The decoded operands.
+    decltype(precomp_instr::f) f;
+};
+
+// Decoded instructions for each 4 KB page of the KSEG0 and KSEG1 ranges, allocated when the page is first executed
+static std::unique_ptr<t_decoded_instr[]> decoded_pages[0x40000];
+
+static void (*resolve_ops(uint32_t op))()
+{
+    switch ((op >> 26) & 0x3F)
+    {
+    case 0:
+        return interp_special[op & 0x3F];
+    case 1:
+        return interp_regimm[(op >> 16) & 0x1F];
+    case 16:
+        return interp_cop0[(op >> 21) & 0x1F];
+    default:
+        return interp_ops[(op >> 26) & 0x3F];
+    }
+}
+
+// Decodes the opcode at interp_addr, reusing the previous decoding if the opcode hasn't changed since
+static void prefetch_decoded(uint32_t op)
+{
+    // NOTE: We compare against the opcode instead of relying on invalid_code, as the pure interpreter doesn't maintain it and the RSP and DMA write to RDRAM behind its back
+    auto& page = decoded_pages[(interp_addr - 0x80000000) >> 12];
+    if (!page)
+    {
+        page = std::make_unique<t_decoded_instr[]>(0x1000 / 4);
+    }
+
+    auto& instr = page[(interp_addr & 0xFFF) / 4];
+    if (!instr.ops || instr.op != op)
+    {
+        prefetch_opcode(op);
+        instr.op = op;
+        instr.ops = resolve_ops(op);
+        instr.f = PC->f;
+    }
+    else
+    {
+        PC->f = instr.f;
+    }
+    fetched_ops = instr.ops;
+}
+
+static void clear_decoded_pages()
+{
+    for (auto& page : decoded_pages)
+    {
+        page.reset();
+    }
+}
+
 // Get opcode from address (interp_address)
 void prefetch()
 {
@@ -3114,17 +3158,17 @@ void prefetch()
             /*if ((debug_count+Count) > 0xabaa20)
               g_core->log_info(L"count:%x, add:%x, op:%x, l{}\n", (int32_t)(Count+debug_count),
                  interp_addr, op, line);*/
-            prefetch_opcode(vr_op);
+            prefetch_decoded(vr_op);
         }
         else if ((interp_addr >= 0xa4000000) && (interp_addr < 0xa4001000))
         {
             vr_op = SP_DMEM[(interp_addr & 0xFFF) / 4];
-            prefetch_opcode(vr_op);
+            prefetch_decoded(vr_op);
         }
         else if ((interp_addr > 0xb0000000))
         {
             vr_op = ((uint32_t*)rom)[(interp_addr & 0xFFFFFFF) / 4];
-            prefetch_opcode(vr_op);
+            prefetch_decoded(vr_op);
         }
         else
         {
@@ -3160,6 +3204,8 @@ void pure_interpreter()
     interp_addr = 0xa4000040;
     stop = 0;
     PC = (precomp_instr*)malloc(sizeof(precomp_instr));
+    fetched_ops = NI;
+    clear_decoded_pages();
     last_addr = interp_addr;
     core_executing = true;
     g_core->callbacks.core_executing_changed(core_executing);
@@ -3172,7 +3218,11 @@ void pure_interpreter()
 
         // if (Count > 0x2000000) g_core->log_info(L"inter:%x,%x", interp_addr,op);
         // if ((Count+debug_count) > 0xabaa2c) stop=1;
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        if (interp_addr >= 0x80000000 && interp_addr < 0xC0000000 && watch_exec_pages[(interp_addr & 0x1FFFFFFF) >> 12])
+        {
+            watch_on_exec(interp_addr);
+        }
+        fetched_ops();
         g_vr_beq_ignore_jmp = false;
 
         // Count = (uint32_t)Count + 2;
@@ -3184,6 +3234,7 @@ void pure_interpreter()
         Debugger::on_late_cycle(vr_op, interp_addr);
     }
     PC->addr = interp_addr;
+    clear_decoded_pages();
 }
 
 void interprete_section(uint32_t addr)
@@ -3197,7 +3248,7 @@ void interprete_section(uint32_t addr)
         if (core_vr_is_tracelog_active())
             tracelog_log_pure();
         PC->addr = interp_addr;
-        interp_ops[((vr_op >> 26) & 0x3F)]();
+        fetched_ops();
     }
     PC->addr = interp_addr;
 }
@@ -8,7 +8,9 @@
 #include <Core.h>
 #include <memory/memory.h>
 #include <memory/pif.h>
+#include <memory/savefile.h>
 #include <memory/savestates.h>
+#include <r4300/code_cache.h>
 #include <r4300/exception.h>
 #include <r4300/interrupt.h>
 #include <r4300/macros.h>
@@ -17,13 +19,22 @@
 #include <r4300/recomp.h>
 #include <r4300/timers.h>
 #include <r4300/vcr.h>
-#include <alloc.h>
 
 std::thread emu_thread_handle;
 std::thread audio_thread_handle;
 
 std::atomic<bool> audio_thread_stop_requested;
 
+// Signalled when the AI state changes or the audio thread is asked to stop
+std::mutex g_audio_mutex;
+std::condition_variable g_audio_cv;
+bool g_audio_update_pending = false;
+
+// Wakes the emu thread up while it waits in the PIF read path (pause, frame advance, wait counter)
+std::mutex g_emu_wait_mutex;
+std::condition_variable g_emu_wait_cv;
+bool g_emu_wake_pending = false;
+
 // Lock to prevent emu state change race conditions
 std::recursive_mutex g_emu_cs;
 
@@ -69,11 +80,6 @@ bool g_vr_fast_forward;
 bool g_vr_frame_skipped;
 core_system_type g_sys_type;
 
-FILE* g_eeprom_file;
-FILE* g_sram_file;
-FILE* g_fram_file;
-FILE* g_mpak_file;
-
 /*#define check_memory() \
    if (!invalid_code[address>>12]) \
        invalid_code[address>>12] = 1;*/
@@ -115,6 +121,7 @@ void core_vr_resume_emu()
         emu_paused = 0;
     }
 
+    emu_thread_notify();
     g_core->callbacks.emu_paused_changed(emu_paused);
 }
 
@@ -1578,6 +1585,10 @@ inline void jump_to_func()
     actual = blocks[addr >> 12];
     if (invalid_code[addr >> 12])
     {
+        if (dynacore && code_cache_needs_flush())
+        {
+            code_cache_flush();
+        }
         if (!blocks[addr >> 12])
         {
             blocks[addr >> 12] = (precomp_block*)malloc(sizeof(precomp_block));
@@ -1706,7 +1717,8 @@ void core_start()
         tlb_e[i].phys_odd = 0;
     }
     memset(tlb_LUT_r, 0, sizeof(tlb_LUT_r));
-    memset(tlb_LUT_r, 0, sizeof(tlb_LUT_w));
+    memset(tlb_LUT_w, 0, sizeof(tlb_LUT_w));
+    tlb_luts_diverged = false;
     llbit = 0;
     hi = 0;
     lo = 0;
@@ -1920,6 +1932,7 @@ void core_start()
     {
         dynacore = 1;
         g_core->log_info(L"dynamic recompiler");
+        code_cache_init();
         init_blocks();
 
         auto code_addr = actual->code + (actual->block[0x40 / 4].local_addr);
@@ -1939,11 +1952,7 @@ void core_start()
                 free(blocks[i]->block);
                 blocks[i]->block = NULL;
             }
-            if (blocks[i]->code)
-            {
-                free_exec(blocks[i]->code);
-                blocks[i]->code = NULL;
-            }
+            blocks[i]->code = NULL;
             if (blocks[i]->jumps_table)
             {
                 free(blocks[i]->jumps_table);
@@ -1953,78 +1962,112 @@ void core_start()
             blocks[i] = NULL;
         }
     }
+    if (dynacore)
+        code_cache_destroy();
     if (!dynacore && interpcore)
         free(PC);
     core_executing = false;
     g_core->callbacks.core_executing_changed(core_executing);
 }
 
-bool open_core_file_stream(const std::filesystem::path& path, FILE** file)
+bool open_save_files()
 {
-    g_core->log_info(std::format(L"[Core] Opening core stream from {}...", path.wstring()));
-
-    if (!exists(path))
-    {
-        FILE* f = nullptr;
-        if (fopen_s(&f, path.string().c_str(), "w"))
-        {
-            return false;
-        }
-        fflush(f);
-        fclose(f);
-    }
-    if (fopen_s(file, path.string().c_str(), "rb+"))
-    {
-        return false;
-    }
-    return *file != nullptr;
+    return savefile_open(g_eeprom_file, get_eeprom_path()) && savefile_open(g_sram_file, get_sram_path()) && savefile_open(g_fram_file, get_flashram_path()) && savefile_open(g_mpak_file, get_mempak_path());
 }
 
+void close_save_files()
+{
+    savefile_close(g_eeprom_file);
+    savefile_close(g_sram_file);
+    savefile_close(g_fram_file);
+    savefile_close(g_mpak_file);
+}
 
 void clear_save_data()
 {
-    open_core_file_stream(get_eeprom_path(), &g_eeprom_file);
-    open_core_file_stream(get_sram_path(), &g_sram_file);
-    open_core_file_stream(get_flashram_path(), &g_fram_file);
-    open_core_file_stream(get_mempak_path(), &g_mpak_file);
+    open_save_files();
 
     {
         memset(sram, 0, sizeof(sram));
-        fseek(g_sram_file, 0, SEEK_SET);
-        fwrite(sram, 1, 0x8000, g_sram_file);
+        savefile_write(g_sram_file, sram, 0x8000);
     }
     {
         memset(eeprom, 0, sizeof(eeprom));
-        fseek(g_eeprom_file, 0, SEEK_SET);
-        fwrite(eeprom, 1, 0x800, g_eeprom_file);
+        savefile_write(g_eeprom_file, eeprom, 0x800);
     }
     {
-        fseek(g_mpak_file, 0, SEEK_SET);
         for (auto buf : mempack)
         {
             memset(buf, 0, sizeof(mempack) / 4);
-            fwrite(buf, 1, 0x800, g_mpak_file);
         }
+        // NOTE: Only the first 0x800 bytes of each mempack's worth of data are cleared in the file
+        savefile_write(g_mpak_file, mempack, 0x800 * std::size(mempack));
+    }
+
+    close_save_files();
+}
+
+void audio_thread_notify()
+{
+    {
+        std::lock_guard lock(g_audio_mutex);
+        g_audio_update_pending = true;
     }
+    g_audio_cv.notify_one();
+}
+
+void emu_thread_notify()
+{
+    {
+        std::lock_guard lock(g_emu_wait_mutex);
+        g_emu_wake_pending = true;
+    }
+    g_emu_wait_cv.notify_one();
+}
 
-    fclose(g_eeprom_file);
-    fclose(g_sram_file);
-    fclose(g_fram_file);
-    fclose(g_mpak_file);
+void emu_thread_wait_until(std::chrono::steady_clock::time_point deadline)
+{
+    std::unique_lock lock(g_emu_wait_mutex);
+    g_emu_wait_cv.wait_until(lock, deadline, [] {
+        return g_emu_wake_pending;
+    });
+    g_emu_wake_pending = false;
 }
 
 void audio_thread()
 {
     g_core->log_info(L"Sound thread entering...");
+    auto last_update = std::chrono::steady_clock::now();
     while (true)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        {
+            std::unique_lock lock(g_audio_mutex);
+            const auto timeout = std::chrono::milliseconds(std::max(g_core->cfg->audio_update_timeout, 1));
+
+            if (g_vr_fast_forward)
+            {
+                // AI events arrive much faster than they're played back while fast-forwarding, so we coalesce them into one update per timeout period
+                g_audio_cv.wait_until(lock, last_update + timeout, [] {
+                    return audio_thread_stop_requested.load();
+                });
+            }
+            else
+            {
+                g_audio_cv.wait_for(lock, timeout, [] {
+                    return g_audio_update_pending || audio_thread_stop_requested;
+                });
+            }
+
+            g_audio_update_pending = false;
+        }
 
         if (audio_thread_stop_requested == true)
         {
             break;
         }
 
+        last_update = std::chrono::steady_clock::now();
+
         if (g_vr_fast_forward && g_core->cfg->fastforward_silent)
         {
             continue;
@@ -2054,6 +2097,16 @@ void emu_thread()
 
     dynacore = g_core->cfg->core_type;
 
+#ifdef _M_X64
+    // The recompiler emits 32-bit x86 code and stores host pointers in 32-bit fields, so it can't run in a 64-bit process.
+    // There's no x86-64 code generator yet, so the cached interpreter is the fastest core available there.
+    if (dynacore == 1)
+    {
+        g_core->log_warn(L"The dynamic recompiler isn't available in 64-bit builds, falling back to the cached interpreter");
+        dynacore = 0;
+    }
+#endif
+
     audio_thread_handle = std::thread(audio_thread);
 
     g_core->callbacks.emu_launched_changed(true);
@@ -2093,7 +2146,11 @@ core_result vr_close_rom_impl(bool stop_vcr)
 
     core_vr_resume_emu();
 
-    audio_thread_stop_requested = true;
+    {
+        std::lock_guard lock(g_audio_mutex);
+        audio_thread_stop_requested = true;
+    }
+    g_audio_cv.notify_one();
     audio_thread_handle.join();
     audio_thread_stop_requested = false;
 
@@ -2111,14 +2168,7 @@ core_result vr_close_rom_impl(bool stop_vcr)
 
     emu_thread_handle.join();
 
-    fflush(g_eeprom_file);
-    fflush(g_sram_file);
-    fflush(g_fram_file);
-    fflush(g_mpak_file);
-    fclose(g_eeprom_file);
-    fclose(g_sram_file);
-    fclose(g_fram_file);
-    fclose(g_mpak_file);
+    close_save_files();
 
     return Res_Ok;
 }
@@ -2179,8 +2229,8 @@ core_result vr_start_rom_impl(std::filesystem::path path)
         return VR_RomInvalid;
     }
 
-    // Open all the save file streams
-    if (!open_core_file_stream(get_eeprom_path(), &g_eeprom_file) || !open_core_file_stream(get_sram_path(), &g_sram_file) || !open_core_file_stream(get_flashram_path(), &g_fram_file) || !open_core_file_stream(get_mempak_path(), &g_mpak_file))
+    // Load all the save files into memory
+    if (!open_save_files())
     {
         g_core->callbacks.emu_starting_changed(false);
         return VR_FileOpenFailed;
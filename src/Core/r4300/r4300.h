@@ -58,11 +58,6 @@ extern bool g_vr_fast_forward;
 extern bool g_vr_frame_skipped;
 extern core_system_type g_sys_type;
 
-extern FILE* g_eeprom_file;
-extern FILE* g_sram_file;
-extern FILE* g_fram_file;
-extern FILE* g_mpak_file;
-
 extern bool g_vr_benchmark_enabled;
 
 void pure_interpreter();
@@ -71,6 +66,23 @@ void update_count();
 int32_t check_cop1_unusable();
 void terminate_emu();
 
+/**
+ * \brief Notifies the audio thread that the AI state changed and the audio plugin should be updated.
+ */
+void audio_thread_notify();
+
+/**
+ * \brief Wakes the emu thread up if it's waiting in <c>emu_thread_wait_until</c>, or makes its next wait return immediately.
+ * \remarks Must be called after changing any state the emu thread waits on (pause, frame advance, wait counter, savestate queue).
+ */
+void emu_thread_notify();
+
+/**
+ * \brief Blocks the emu thread until <c>emu_thread_notify</c> is called or the deadline is reached.
+ * \param deadline The point in time after which the wait returns regardless of notifications.
+ */
+void emu_thread_wait_until(std::chrono::steady_clock::time_point deadline);
+
 core_result vr_reset_rom_impl(bool reset_save_data, bool stop_vcr, bool skip_reset_recording_check = false);
 
 
@@ -7,6 +7,7 @@
 #include "stdafx.h"
 #include <Core.h>
 #include <memory/memory.h>
+#include <r4300/code_cache.h>
 #include <r4300/macros.h>
 #include <r4300/ops.h>
 #include <r4300/r4300.h>
@@ -15,7 +16,6 @@
 #include <r4300/rom.h>
 #include <r4300/tracelog.h>
 #include <r4300/x86/regcache.h>
-#include <alloc.h>
 
 // global variables :
 precomp_instr* dst; // destination structure for the recompiled instruction
@@ -2482,10 +2482,12 @@ void init_block(int32_t* source, precomp_block* block)
     }
     if (dynacore)
     {
-        if (!block->code)
+        // Code from a previous cache generation is left alone, as it may still be executing
+        if (!block->code || !code_cache_is_current(block->code))
         {
-            block->code = (unsigned char*)malloc_exec(CODE_BLOCK_SIZE);
+            block->code = (unsigned char*)code_cache_alloc(CODE_BLOCK_SIZE);
             max_code_length = CODE_BLOCK_SIZE;
+            already_exist = 0;
         }
         else
             max_code_length = block->max_code_length;
@@ -2613,6 +2615,7 @@ void recompile_block(int32_t* source, precomp_block* block, uint32_t func)
     int32_t i, length, finished = 0;
     length = (block->end - block->start) / 4;
     dst_block = block;
+    const auto start_time = std::chrono::steady_clock::now();
 
     block->hash = 0;
 
@@ -2711,6 +2714,7 @@ void recompile_block(int32_t* source, precomp_block* block, uint32_t func)
         block->code_length = code_length;
         block->max_code_length = max_code_length;
         free_assembler(&block->jumps_table, &block->jumps_number);
+        code_cache_on_block_compiled(std::chrono::steady_clock::now() - start_time);
     }
     // g_core->log_info(L"block recompiled ({:#06x}-%x)\n", (int32_t)func, (int32_t)(block->start+i*4));
     // getchar();
@@ -16,8 +16,79 @@ extern int32_t m_current_sample;
 
 std::chrono::duration<double, std::milli> max_vi_s_ms;
 
-size_t frame_deltas_ptr = 0;
-size_t vi_deltas_ptr = 0;
+/**
+ * \brief A ring buffer of timer deltas written by a single producer (the emulation thread) which can be read from any thread without locking.
+ */
+struct t_delta_ring {
+    /// The deltas in nanoseconds. Empty slots are 0.
+    std::atomic<int64_t> deltas[core_timer_max_deltas]{};
+    /// The index of the next slot to write to. Only accessed by the producer.
+    size_t index = 0;
+    /// Whether the producer should start writing from the first slot again. Set by <c>clear</c>, which can be called from any thread.
+    std::atomic<bool> reset_pending = false;
+
+    void push(const core_timer_delta delta)
+    {
+        if (reset_pending.exchange(false, std::memory_order_relaxed))
+        {
+            index = 0;
+        }
+        deltas[index].store(delta.count(), std::memory_order_relaxed);
+        index = (index + 1) % core_timer_max_deltas;
+    }
+
+    void clear()
+    {
+        for (auto& delta : deltas)
+        {
+            delta.store(0, std::memory_order_relaxed);
+        }
+        reset_pending.store(true, std::memory_order_relaxed);
+    }
+
+    core_timer_stats get_stats() const
+    {
+        // NOTE: The snapshot can mix deltas from before and after a concurrent push, which is fine for rolling statistics
+        int64_t snapshot[core_timer_max_deltas];
+        size_t count = 0;
+        for (const auto& delta : deltas)
+        {
+            const auto value = delta.load(std::memory_order_relaxed);
+            if (value > 0)
+            {
+                snapshot[count++] = value;
+            }
+        }
+
+        if (count == 0)
+        {
+            return {};
+        }
+
+        std::sort(snapshot, snapshot + count);
+
+        const auto percentile = [&](const size_t p) {
+            // Nearest-rank percentile
+            const size_t rank = (p * count + 99) / 100;
+            return core_timer_delta(snapshot[std::max(rank, (size_t)1) - 1]);
+        };
+
+        const auto sum = std::accumulate(snapshot, snapshot + count, (int64_t)0);
+        const auto avg = core_timer_delta(sum / (int64_t)count);
+
+        return core_timer_stats{
+        .min = core_timer_delta(snapshot[0]),
+        .avg = avg,
+        .p95 = percentile(95),
+        .p99 = percentile(99),
+        .max = core_timer_delta(snapshot[count - 1]),
+        .rate = 1'000'000'000.0 / ((double)sum / (double)count),
+        };
+    }
+};
+
+t_delta_ring g_frame_deltas;
+t_delta_ring g_vi_deltas;
 
 time_point last_vi_time;
 time_point last_frame_time;
@@ -31,27 +102,28 @@ void core_vr_on_speed_modifier_changed()
     last_frame_time = std::chrono::high_resolution_clock::now();
     last_vi_time = std::chrono::high_resolution_clock::now();
 
-    for (auto& delta : g_core->g_frame_deltas)
-    {
-        delta = {};
-    }
-    for (auto& delta : g_core->g_vi_deltas)
-    {
-        delta = {};
-    }
+    g_frame_deltas.clear();
+    g_vi_deltas.clear();
+}
+
+core_timer_info core_vr_get_timer_info()
+{
+    core_timer_info info = {
+    .frame = g_frame_deltas.get_stats(),
+    .vi = g_vi_deltas.get_stats(),
+    };
+
+    const auto intended_vis = core_vr_get_vis_per_second(ROM_HEADER.Country_code);
+    info.speed = intended_vis ? info.vi.rate / intended_vis * 100.0 : 0.0;
 
-    frame_deltas_ptr = 0;
-    vi_deltas_ptr = 0;
+    return info;
 }
 
 void timer_new_frame()
 {
     const auto current_frame_time = std::chrono::high_resolution_clock::now();
 
-    g_core->g_frame_deltas_mutex.lock();
-    g_core->g_frame_deltas[frame_deltas_ptr] = current_frame_time - last_frame_time;
-    g_core->g_frame_deltas_mutex.unlock();
-    frame_deltas_ptr = (frame_deltas_ptr + 1) % core_timer_max_deltas;
+    g_frame_deltas.push(current_frame_time - last_frame_time);
 
     g_core->callbacks.frame();
     last_frame_time = std::chrono::high_resolution_clock::now();
@@ -105,10 +177,7 @@ void timer_new_vi()
         }
     }
 
-    g_core->g_vi_deltas_mutex.lock();
-    g_core->g_vi_deltas[vi_deltas_ptr] = current_vi_time - last_vi_time;
-    g_core->g_vi_deltas_mutex.unlock();
-    vi_deltas_ptr = (vi_deltas_ptr + 1) % core_timer_max_deltas;
+    g_vi_deltas.push(current_vi_time - last_vi_time);
 
     last_vi_time = std::chrono::high_resolution_clock::now();
 }
@@ -5,6 +5,7 @@
  */
 
 #include "stdafx.h"
+#include <io.h>
 #include <IOHelpers.h>
 #include <Core.h>
 #include <cheats.h>
@@ -45,7 +46,31 @@ std::optional<size_t> seek_to_frame;
 bool g_seek_pause_at_end;
 std::atomic g_seek_savestate_loading = false;
 std::atomic g_reset_pending = false;
-std::unordered_map<size_t, std::vector<uint8_t>> g_seek_savestates;
+
+/// A seek savestate, which is either stored in full (a keyframe) or as a page delta against a keyframe.
+struct t_seek_savestate {
+    /// The frame of the keyframe the buffer is a delta against. Equal to the savestate's own frame if it's a keyframe.
+    size_t base_frame;
+
+    /// The savestate buffer if the savestate is a keyframe, otherwise the delta buffer. Compressed with <c>codec</c>.
+    std::shared_ptr<const std::vector<uint8_t>> buffer;
+
+    /// The codec the buffer is compressed with. Savestates start out uncompressed and are compressed in the background.
+    core_st_codec codec;
+
+    /// The buffer's uncompressed size.
+    size_t size;
+
+    /// A unique identifier for the buffer, used to detect whether the savestate was replaced while being compressed.
+    uint64_t id;
+};
+
+std::unordered_map<size_t, t_seek_savestate> g_seek_savestates;
+uint64_t g_seek_savestate_id = 0;
+
+// The most recently used keyframe in uncompressed form, which saves us from decompressing it for every new delta.
+std::optional<size_t> g_seek_keyframe_cache_frame;
+std::vector<uint8_t> g_seek_keyframe_cache;
 
 bool g_warp_modify_active = false;
 size_t g_warp_modify_first_difference_frame = 0;
@@ -54,6 +79,15 @@ core_vcr_movie_header g_header;
 std::vector<core_buttons> g_movie_inputs;
 std::filesystem::path g_movie_path;
 
+// The amount of inputs in a full input snapshot chunk
+constexpr size_t VCR_INPUT_CHUNK_SIZE = 4096;
+
+// The most recent snapshot of the movie inputs. The next snapshot shares all full chunks which haven't been modified since.
+core_vcr_input_snapshot g_input_snapshot{};
+
+// The index of the first movie input which might have been modified since g_input_snapshot was taken. Never larger than the snapshot's size.
+size_t g_input_snapshot_dirty_from = 0;
+
 int32_t m_current_sample = -1;
 int32_t m_current_vi = -1;
 
@@ -64,34 +98,251 @@ std::recursive_mutex vcr_mutex;
 
 bool vcr_is_task_recording(core_vcr_task task);
 
-bool write_movie_impl(const core_vcr_movie_header* hdr, const std::vector<core_buttons>& inputs, const std::filesystem::path& path)
-{
-    g_core->log_info(std::format(L"[VCR] write_movie_impl to {}...", g_movie_path.wstring()));
+/// A movie update which is written to disk by the movie writer.
+struct t_movie_write {
+    /// The path the movie is written to.
+    std::filesystem::path path;
+
+    /// The movie header, with the extended format sections already cleared if needed.
+    core_vcr_movie_header header;
+
+    /// The index of the first input in <c>inputs</c>. Always 0 for backups.
+    size_t offset;
+
+    /// The movie inputs starting at <c>offset</c>, up to <c>header.length_samples</c>. The inputs before <c>offset</c> are the ones enqueued by previous writes to the same path.
+    std::vector<core_buttons> inputs;
+
+    /// Whether the write is a backup. Backups are always written in full and don't affect the tracked movie file.
+    bool backup;
+
+    /// Whether a failure is reported to the next <c>vcr_wait_for_movie_writes</c> caller. Otherwise, it's only logged by the worker.
+    bool report_failure;
+};
+
+// The movie write queue mutex. Locked when accessing the write queue, the pending write count or the write error flag.
+std::mutex g_movie_write_mutex;
+
+// Signalled when a pending movie write completes.
+std::condition_variable g_movie_write_cv;
 
+// The movie write queue, processed in order by a single worker at a time.
+std::deque<t_movie_write> g_movie_writes;
+
+// The amount of movie writes which are queued or currently being processed.
+size_t g_pending_movie_writes = 0;
+
+// Whether a worker is currently processing the movie write queue.
+bool g_movie_write_worker_active = false;
+
+// Whether a movie write which reports its failure failed since the last call to vcr_wait_for_movie_writes.
+bool g_movie_write_failed = false;
+
+// The movie file the writer was last asked to update, and the amount of its inputs which were enqueued and still match g_movie_inputs. Only accessed by the emulation thread.
+std::filesystem::path g_enqueued_movie_path;
+size_t g_enqueued_movie_length = 0;
+
+// The movie file last updated by the worker and the inputs it should contain after all writes to it were applied. Only accessed by the worker.
+std::filesystem::path g_disk_movie_path;
+std::vector<core_buttons> g_disk_movie_inputs;
+
+// Whether the movie file last updated by the worker actually contains g_disk_movie_inputs. Only accessed by the worker.
+bool g_disk_movie_synced = false;
+
+/**
+ * \brief Writes a movie to a new file, replacing any existing one.
+ */
+static bool write_movie_full(const std::filesystem::path& path, const core_vcr_movie_header& header, const std::vector<core_buttons>& inputs)
+{
     FILE* f = nullptr;
     if (fopen_s(&f, path.string().c_str(), "wb+"))
     {
         return false;
     }
 
-    core_vcr_movie_header hdr_copy = *hdr;
+    bool success = fwrite(&header, sizeof(core_vcr_movie_header), 1, f) == 1;
+    success &= fwrite(inputs.data(), sizeof(core_buttons), inputs.size(), f) == inputs.size();
 
-    if (!g_core->cfg->vcr_write_extended_format)
+    if (g_core->cfg->vcr_fsync)
     {
-        g_core->log_info(L"[VCR] vcr_write_extended_format disabled, replacing new sections with 0...");
-        hdr_copy.extended_version = 0;
-        memset(&hdr_copy.extended_flags, 0, sizeof(hdr_copy.extended_flags));
-        memset(hdr_copy.extended_data.authorship_tag, 0, sizeof(hdr_copy.extended_data.authorship_tag));
-        memset(&hdr_copy.extended_data, 0, sizeof(hdr_copy.extended_flags));
+        success &= fflush(f) == 0 && _commit(_fileno(f)) == 0;
     }
 
-    fwrite(&hdr_copy, sizeof(core_vcr_movie_header), 1, f);
-    fwrite(inputs.data(), sizeof(core_buttons), hdr_copy.length_samples, f);
     fclose(f);
-    return true;
+    return success;
+}
+
+/**
+ * \brief Applies a movie write to the movie file previously written by the worker.
+ * The header is patched in place, and only the write's inputs are written at their offset. The file must not get shorter.
+ */
+static bool write_movie_patch(const t_movie_write& write)
+{
+    FILE* f = nullptr;
+    if (fopen_s(&f, write.path.string().c_str(), "rb+"))
+    {
+        return false;
+    }
+
+    bool success = fwrite(&write.header, sizeof(core_vcr_movie_header), 1, f) == 1;
+
+    if (!write.inputs.empty())
+    {
+        success &= fseek(f, (long)(sizeof(core_vcr_movie_header) + sizeof(core_buttons) * write.offset), SEEK_SET) == 0;
+        success &= fwrite(write.inputs.data(), sizeof(core_buttons), write.inputs.size(), f) == write.inputs.size();
+    }
+
+    if (g_core->cfg->vcr_fsync)
+    {
+        success &= fflush(f) == 0 && _commit(_fileno(f)) == 0;
+    }
+
+    fclose(f);
+
+    g_core->log_trace(std::format(L"[VCR] Wrote {} of {} input samples", write.inputs.size(), write.offset + write.inputs.size()));
+
+    return success;
+}
+
+/**
+ * \brief Writes the queued movie updates to disk in order. Runs on a worker thread.
+ */
+static void vcr_movie_write_worker()
+{
+    while (true)
+    {
+        t_movie_write write;
+        {
+            std::scoped_lock lock(g_movie_write_mutex);
+            if (g_movie_writes.empty())
+            {
+                g_movie_write_worker_active = false;
+                break;
+            }
+            write = std::move(g_movie_writes.front());
+            g_movie_writes.pop_front();
+        }
+
+        g_core->log_trace(std::format(L"[VCR] Writing movie to {}...", write.path.wstring()));
+
+        bool success;
+        if (write.backup)
+        {
+            success = write_movie_full(write.path, write.header, write.inputs);
+        }
+        else
+        {
+            if (write.path != g_disk_movie_path)
+            {
+                g_disk_movie_path = write.path;
+                g_disk_movie_inputs.clear();
+                g_disk_movie_synced = false;
+            }
+
+            const size_t disk_length = g_disk_movie_inputs.size();
+            g_disk_movie_inputs.resize(write.offset);
+            g_disk_movie_inputs.insert(g_disk_movie_inputs.end(), write.inputs.begin(), write.inputs.end());
+
+            // The file is only patched if it still looks like what we last wrote to it, as it might have been deleted or replaced in the meantime.
+            // Truncated movies are rewritten in full.
+            std::error_code ec;
+            const auto expected_size = sizeof(core_vcr_movie_header) + sizeof(core_buttons) * disk_length;
+            const bool patch = g_disk_movie_synced && g_disk_movie_inputs.size() >= disk_length && std::filesystem::file_size(write.path, ec) == expected_size && !ec;
+
+            success = patch ? write_movie_patch(write) : write_movie_full(write.path, write.header, g_disk_movie_inputs);
+            g_disk_movie_synced = success;
+        }
+
+        if (!success)
+        {
+            g_core->log_error(std::format(L"[VCR] Failed to write movie to {}", write.path.wstring()));
+        }
+
+        {
+            std::scoped_lock lock(g_movie_write_mutex);
+            g_movie_write_failed |= !success && write.report_failure;
+            --g_pending_movie_writes;
+        }
+        g_movie_write_cv.notify_all();
+    }
 }
 
-// Writes the movie header + inputs to current movie_path
+/**
+ * \brief Enqueues a movie update to be written to disk on a worker thread.
+ * \param hdr The movie header.
+ * \param inputs The movie inputs. Only the inputs from <c>offset</c> up to <c>hdr->length_samples</c> are written.
+ * \param offset The index of the first input to write. The inputs before it must have been enqueued by previous writes to the same path. Must be 0 for backups.
+ * \param path The path to write the movie to.
+ * \param backup Whether the write is a backup.
+ * \param report_failure Whether a failure is reported to the next <c>vcr_wait_for_movie_writes</c> caller.
+ */
+static void vcr_enqueue_movie_write(const core_vcr_movie_header* hdr, const std::vector<core_buttons>& inputs, size_t offset, const std::filesystem::path& path, bool backup, bool report_failure = true)
+{
+    const size_t length = std::min((size_t)hdr->length_samples, inputs.size());
+    offset = std::min(offset, length);
+
+    t_movie_write write{
+    .path = path,
+    .header = *hdr,
+    .offset = offset,
+    .inputs = std::vector(inputs.begin() + offset, inputs.begin() + length),
+    .backup = backup,
+    .report_failure = report_failure,
+    };
+
+    if (!g_core->cfg->vcr_write_extended_format)
+    {
+        write.header.extended_version = 0;
+        memset(&write.header.extended_flags, 0, sizeof(write.header.extended_flags));
+        memset(write.header.extended_data.authorship_tag, 0, sizeof(write.header.extended_data.authorship_tag));
+        memset(&write.header.extended_data, 0, sizeof(write.header.extended_flags));
+    }
+
+    std::scoped_lock lock(g_movie_write_mutex);
+
+    // A queued write to the same movie file which hasn't been started yet is merged into this one
+    if (!backup && !g_movie_writes.empty() && !g_movie_writes.back().backup && g_movie_writes.back().path == path)
+    {
+        auto& queued = g_movie_writes.back();
+        if (write.offset > queued.offset)
+        {
+            queued.inputs.resize(write.offset - queued.offset);
+            queued.inputs.insert(queued.inputs.end(), write.inputs.begin(), write.inputs.end());
+            write.inputs = std::move(queued.inputs);
+            write.offset = queued.offset;
+        }
+        queued = std::move(write);
+        return;
+    }
+
+    g_movie_writes.push_back(std::move(write));
+    ++g_pending_movie_writes;
+
+    if (g_movie_write_worker_active)
+    {
+        return;
+    }
+
+    g_movie_write_worker_active = true;
+    g_core->submit_task(vcr_movie_write_worker);
+}
+
+/**
+ * \brief Waits until all pending movie writes have been completed.
+ * \return Whether all movie writes completed since the last call succeeded.
+ */
+static bool vcr_wait_for_movie_writes()
+{
+    std::unique_lock lock(g_movie_write_mutex);
+    g_movie_write_cv.wait(lock, [] {
+        return g_pending_movie_writes == 0;
+    });
+
+    const bool success = !g_movie_write_failed;
+    g_movie_write_failed = false;
+    return success;
+}
+
+// Enqueues a write of the movie header + inputs to current movie_path
 bool write_movie()
 {
     if (!vcr_is_task_recording(g_task))
@@ -102,15 +353,28 @@ bool write_movie()
 
     g_core->log_info(L"[VCR] Flushing current movie...");
 
-    return write_movie_impl(&g_header, g_movie_inputs, g_movie_path);
+    // Only the inputs which weren't enqueued yet or were modified since are written
+    if (g_movie_path != g_enqueued_movie_path)
+    {
+        g_enqueued_movie_path = g_movie_path;
+        g_enqueued_movie_length = 0;
+    }
+
+    vcr_enqueue_movie_write(&g_header, g_movie_inputs, g_enqueued_movie_length, g_movie_path, false);
+    g_enqueued_movie_length = std::min((size_t)g_header.length_samples, g_movie_inputs.size());
+    return true;
 }
 
-bool write_backup_impl()
+/**
+ * \brief Enqueues a backup of the current movie to the backups directory. The backup is written asynchronously.
+ * \param report_failure Whether a failure is reported to the next <c>vcr_wait_for_movie_writes</c> caller. Otherwise, it's only logged.
+ */
+void write_backup_impl(bool report_failure)
 {
     g_core->log_info(L"[VCR] Backing up movie...");
     const auto filename = std::format("{}.{}.m64", g_movie_path.stem().string(), static_cast<uint64_t>(time(nullptr)));
 
-    return write_movie_impl(&g_header, g_movie_inputs, g_core->get_backups_directory() / filename);
+    vcr_enqueue_movie_write(&g_header, g_movie_inputs, 0, g_core->get_backups_directory() / filename, true, report_failure);
 }
 
 bool is_task_playback(const core_vcr_task task)
@@ -369,6 +633,79 @@ bool vcr_is_playing()
     return g_task == task_playback;
 }
 
+core_vcr_input_snapshot vcr_make_input_snapshot(const core_buttons* inputs, size_t count)
+{
+    core_vcr_input_snapshot snapshot{.size = count};
+    snapshot.chunks.reserve((count + VCR_INPUT_CHUNK_SIZE - 1) / VCR_INPUT_CHUNK_SIZE);
+
+    for (size_t i = 0; i < count; i += VCR_INPUT_CHUNK_SIZE)
+    {
+        const size_t chunk_size = std::min(VCR_INPUT_CHUNK_SIZE, count - i);
+        snapshot.chunks.push_back(std::make_shared<const std::vector<core_buttons>>(inputs + i, inputs + i + chunk_size));
+    }
+
+    return snapshot;
+}
+
+void vcr_read_input_snapshot(const core_vcr_input_snapshot& snapshot, core_buttons* inputs, size_t count)
+{
+    size_t offset = 0;
+    for (const auto& chunk : snapshot.chunks)
+    {
+        if (offset >= count)
+        {
+            break;
+        }
+        const size_t chunk_count = std::min(chunk->size(), count - offset);
+        memcpy(inputs + offset, chunk->data(), sizeof(core_buttons) * chunk_count);
+        offset += chunk_count;
+    }
+
+    if (offset < count)
+    {
+        memset(inputs + offset, 0, sizeof(core_buttons) * (count - offset));
+    }
+}
+
+/**
+ * \brief Marks the movie inputs starting at the specified index as modified, preventing the next input snapshot from sharing the chunks containing them and the next movie write from skipping them.
+ */
+static void vcr_invalidate_input_snapshot(size_t index)
+{
+    g_input_snapshot_dirty_from = std::min(g_input_snapshot_dirty_from, index);
+    g_enqueued_movie_length = std::min(g_enqueued_movie_length, index);
+}
+
+/**
+ * \brief Takes a snapshot of the movie inputs, sharing all unmodified full chunks with the previous snapshot.
+ */
+static core_vcr_input_snapshot vcr_take_input_snapshot()
+{
+    const size_t count = g_header.length_samples;
+
+    core_vcr_input_snapshot snapshot{.size = count};
+    snapshot.chunks.reserve((count + VCR_INPUT_CHUNK_SIZE - 1) / VCR_INPUT_CHUNK_SIZE);
+
+    for (size_t i = 0; i < count; i += VCR_INPUT_CHUNK_SIZE)
+    {
+        const size_t chunk_size = std::min(VCR_INPUT_CHUNK_SIZE, count - i);
+        const size_t chunk_index = i / VCR_INPUT_CHUNK_SIZE;
+
+        if (chunk_size == VCR_INPUT_CHUNK_SIZE && i + chunk_size <= g_input_snapshot_dirty_from && chunk_index < g_input_snapshot.chunks.size())
+        {
+            snapshot.chunks.push_back(g_input_snapshot.chunks[chunk_index]);
+            continue;
+        }
+
+        snapshot.chunks.push_back(std::make_shared<const std::vector<core_buttons>>(g_movie_inputs.begin() + i, g_movie_inputs.begin() + i + chunk_size));
+    }
+
+    g_input_snapshot = snapshot;
+    g_input_snapshot_dirty_from = count;
+
+    return snapshot;
+}
+
 bool core_vcr_freeze(core_vcr_freeze_info* freeze)
 {
     std::scoped_lock lock(vcr_mutex);
@@ -388,10 +725,9 @@ bool core_vcr_freeze(core_vcr_freeze_info* freeze)
     .length_samples = g_header.length_samples,
     };
 
-    // NOTE: The frozen input buffer is weird: its length is traditionally equal to length_samples + 1, which means the last frame is garbage data
-    current_freeze.input_buffer = {};
-    current_freeze.input_buffer.resize(g_header.length_samples + 1);
-    memcpy(current_freeze.input_buffer.data(), g_movie_inputs.data(), sizeof(core_buttons) * g_header.length_samples);
+    // NOTE: The frozen input buffer is weird: its length is traditionally equal to length_samples + 1, which means the last frame is garbage data.
+    // The snapshot only holds the real inputs, and the garbage frame is added back when serializing.
+    current_freeze.input_buffer = vcr_take_input_snapshot();
 
     // Also probably a good time to flush the movie
     write_movie();
@@ -464,16 +800,29 @@ core_result core_vcr_unfreeze(core_vcr_freeze_info freeze)
 
         if (!g_warp_modify_active)
         {
-            g_header.length_samples = freeze.current_sample;
+            std::vector<core_buttons> inputs(freeze.current_sample);
+            vcr_read_input_snapshot(freeze.input_buffer, inputs.data(), inputs.size());
 
-            // Before overwriting the input buffer, save a backup
-            if (g_core->cfg->vcr_backups)
+            // Before overwriting the input buffer, save a backup. It's only needed if inputs would actually be lost, which isn't the case when the savestate's inputs are a continuation of the movie.
+            const size_t kept_samples = std::min((size_t)freeze.current_sample, (size_t)g_header.length_samples);
+            const auto mismatch = std::mismatch(inputs.begin(), inputs.begin() + kept_samples, g_movie_inputs.begin(), [](const core_buttons& a, const core_buttons& b) {
+                return a.value == b.value;
+            });
+            const size_t first_difference = mismatch.first - inputs.begin();
+            const bool inputs_lost = freeze.current_sample < g_header.length_samples || first_difference < kept_samples;
+            if (g_core->cfg->vcr_backups && inputs_lost)
             {
-                write_backup_impl();
+                // Nobody waits for this write, so a failure mustn't be attributed to an unrelated movie write
+                write_backup_impl(false);
             }
 
-            g_movie_inputs.resize(freeze.current_sample);
-            memcpy(g_movie_inputs.data(), freeze.input_buffer.data(), sizeof(core_buttons) * freeze.current_sample);
+            g_header.length_samples = freeze.current_sample;
+            g_movie_inputs = std::move(inputs);
+
+            // The inputs now match the savestate's snapshot, so its chunks can be shared by the next one
+            g_input_snapshot = freeze.input_buffer;
+            g_input_snapshot_dirty_from = std::min((size_t)freeze.current_sample, freeze.input_buffer.size);
+            g_enqueued_movie_length = std::min(g_enqueued_movie_length, first_difference);
 
             write_movie();
         }
@@ -502,8 +851,302 @@ finish:
 
 core_result core_vcr_write_backup()
 {
-    const auto result = write_backup_impl();
-    return result ? Res_Ok : VCR_BadFile;
+    write_backup_impl(true);
+    return vcr_wait_for_movie_writes() ? Res_Ok : VCR_BadFile;
+}
+
+static std::vector<size_t> vcr_evict_seek_savestates();
+
+/**
+ * \brief Creates an uncompressed seek savestate.
+ * \param base_frame The frame of the keyframe the buffer is a delta against, or the savestate's own frame if it's a keyframe.
+ * \param buf The savestate or delta buffer.
+ */
+static t_seek_savestate vcr_make_seek_savestate(size_t base_frame, std::vector<uint8_t>&& buf)
+{
+    const auto size = buf.size();
+    return t_seek_savestate{
+    .base_frame = base_frame,
+    .buffer = std::make_shared<const std::vector<uint8_t>>(std::move(buf)),
+    .codec = core_st_codec_none,
+    .size = size,
+    .id = ++g_seek_savestate_id,
+    };
+}
+
+/**
+ * \brief Gets the uncompressed contents of a seek savestate's buffer. For deltas, this is the delta buffer.
+ */
+static std::vector<uint8_t> vcr_decompress_seek_savestate(const t_seek_savestate& st)
+{
+    return st_decompress(st.codec, *st.buffer, st.size);
+}
+
+/**
+ * \brief Gets the full buffer of a keyframe, going through the keyframe cache.
+ * \param frame The keyframe's frame.
+ */
+static const std::vector<uint8_t>& vcr_get_keyframe_buffer(size_t frame)
+{
+    std::scoped_lock lock(vcr_mutex);
+
+    if (g_seek_keyframe_cache_frame != frame)
+    {
+        g_seek_keyframe_cache = vcr_decompress_seek_savestate(g_seek_savestates.at(frame));
+        g_seek_keyframe_cache_frame = frame;
+    }
+
+    return g_seek_keyframe_cache;
+}
+
+/**
+ * \brief Gets the full buffer of a seek savestate, reconstructing it from its keyframe if needed.
+ * \param frame The seek savestate's frame.
+ * \return The savestate buffer, or an empty vector if no seek savestate exists at the frame.
+ */
+static std::vector<uint8_t> vcr_get_seek_savestate_buffer(size_t frame)
+{
+    std::scoped_lock lock(vcr_mutex);
+
+    if (!g_seek_savestates.contains(frame))
+    {
+        return {};
+    }
+
+    const auto& st = g_seek_savestates.at(frame);
+
+    if (st.base_frame == frame)
+    {
+        return vcr_get_keyframe_buffer(frame);
+    }
+
+    return st_apply_delta(vcr_get_keyframe_buffer(st.base_frame), vcr_decompress_seek_savestate(st));
+}
+
+/**
+ * \brief Compresses a seek savestate with the configured codec in the background.
+ * \param frame The seek savestate's frame.
+ */
+static void vcr_compress_seek_savestate_async(size_t frame)
+{
+    std::scoped_lock lock(vcr_mutex);
+
+    const auto codec = (core_st_codec)g_core->cfg->seek_savestate_codec;
+    const auto& st = g_seek_savestates.at(frame);
+
+    if (codec == core_st_codec_none || st.codec != core_st_codec_none)
+    {
+        return;
+    }
+
+    const auto id = st.id;
+    const auto buffer = st.buffer;
+
+    g_core->submit_task([=] {
+        auto compressed = st_compress(codec, *buffer);
+
+        std::vector<size_t> evicted;
+        {
+            std::scoped_lock lock(vcr_mutex);
+
+            // The savestate might have been erased or replaced in the meantime
+            if (compressed.empty() || !g_seek_savestates.contains(frame) || g_seek_savestates.at(frame).id != id)
+            {
+                return;
+            }
+
+            auto& target = g_seek_savestates.at(frame);
+            target.buffer = std::make_shared<const std::vector<uint8_t>>(std::move(compressed));
+            target.codec = codec;
+
+            evicted = vcr_evict_seek_savestates();
+        }
+
+        for (const auto victim : evicted)
+        {
+            g_core->callbacks.seek_savestate_changed(victim);
+        }
+    });
+}
+
+/**
+ * \brief Erases a seek savestate. If the savestate is a keyframe, the savestates depending on it are erased along with it.
+ * \param frame The seek savestate's frame.
+ * \return The frames of the erased savestates. The caller must invoke the seek_savestate_changed callback for them after releasing the VCR mutex.
+ */
+static std::vector<size_t> vcr_erase_seek_savestate(size_t frame)
+{
+    std::scoped_lock lock(vcr_mutex);
+
+    if (!g_seek_savestates.contains(frame))
+    {
+        return {};
+    }
+
+    // Dependants aren't re-encoded against another keyframe, as that means decompressing and diffing all of them on the emulation thread
+    std::vector<size_t> erased = {frame};
+    if (g_seek_savestates.at(frame).base_frame == frame)
+    {
+        for (const auto& [key, st] : g_seek_savestates)
+        {
+            if (key != frame && st.base_frame == frame)
+            {
+                erased.push_back(key);
+            }
+        }
+    }
+
+    for (const auto key : erased)
+    {
+        if (g_seek_keyframe_cache_frame == key)
+        {
+            g_seek_keyframe_cache_frame.reset();
+            g_seek_keyframe_cache.clear();
+        }
+
+        g_seek_savestates.erase(key);
+    }
+
+    return erased;
+}
+
+/**
+ * \brief Evicts seek savestates until the configured count and size limits are satisfied.
+ * Evicts the savestate whose removal leaves the smallest gap between its neighbours, so the remaining ones stay evenly spaced. The first and last savestates are never evicted.
+ * Deltas are evicted before keyframes, as evicting a keyframe also evicts the savestates depending on it.
+ * \return The frames of the evicted savestates. The caller must invoke the seek_savestate_changed callback for them after releasing the VCR mutex.
+ */
+static std::vector<size_t> vcr_evict_seek_savestates()
+{
+    std::scoped_lock lock(vcr_mutex);
+
+    const size_t max_size = (size_t)g_core->cfg->seek_savestate_max_size * 1024 * 1024;
+    std::vector<size_t> evicted;
+
+    while (g_seek_savestates.size() > 2)
+    {
+        // Savestates still waiting for compression are estimated using the compression ratio of the ones that are already done
+        size_t compressed_size = 0;
+        size_t compressed_original_size = 0;
+        size_t pending_size = 0;
+        for (const auto& [_, st] : g_seek_savestates)
+        {
+            if (st.codec == core_st_codec_none && g_core->cfg->seek_savestate_codec != core_st_codec_none)
+            {
+                pending_size += st.size;
+            }
+            else
+            {
+                compressed_size += st.buffer->size();
+                compressed_original_size += st.size;
+            }
+        }
+
+        const double ratio = compressed_original_size == 0 ? 1.0 : (double)compressed_size / (double)compressed_original_size;
+        const size_t total_size = compressed_size + (size_t)((double)pending_size * ratio);
+
+        const bool count_exceeded = g_seek_savestates.size() > g_core->cfg->seek_savestate_max_count;
+        const bool size_exceeded = max_size != 0 && total_size > max_size;
+
+        if (!count_exceeded && !size_exceeded)
+        {
+            break;
+        }
+
+        std::vector<size_t> frames;
+        frames.reserve(g_seek_savestates.size());
+        for (const auto& [key, _] : g_seek_savestates)
+        {
+            frames.push_back(key);
+        }
+        std::ranges::sort(frames);
+
+        const auto find_victim = [&](bool keyframe) -> std::optional<size_t> {
+            std::optional<size_t> victim;
+            size_t smallest_gap = SIZE_MAX;
+            for (size_t i = 1; i < frames.size() - 1; ++i)
+            {
+                const bool is_keyframe = g_seek_savestates.at(frames[i]).base_frame == frames[i];
+                if (is_keyframe != keyframe)
+                {
+                    continue;
+                }
+
+                // The last savestate would be evicted along with its keyframe
+                if (is_keyframe && g_seek_savestates.at(frames.back()).base_frame == frames[i])
+                {
+                    continue;
+                }
+
+                const auto gap = frames[i + 1] - frames[i - 1];
+                if (gap < smallest_gap)
+                {
+                    smallest_gap = gap;
+                    victim = frames[i];
+                }
+            }
+            return victim;
+        };
+
+        auto victim = find_victim(false);
+        if (!victim.has_value())
+        {
+            victim = find_victim(true);
+        }
+        if (!victim.has_value())
+        {
+            break;
+        }
+
+        g_core->log_info(std::format(L"[VCR] Seek savestates too large ({} states, ~{} bytes)! Purging seek savestate at frame {}...", g_seek_savestates.size(), total_size, victim.value()));
+        const auto erased = vcr_erase_seek_savestate(victim.value());
+        evicted.insert(evicted.end(), erased.begin(), erased.end());
+    }
+
+    return evicted;
+}
+
+/**
+ * \brief Stores a seek savestate, encoding it as a delta against the closest preceding keyframe if possible.
+ * \param frame The seek savestate's frame.
+ * \param buf The savestate buffer.
+ * \return The frames of other savestates which were erased because they depended on a keyframe previously stored at the frame. The caller must invoke the seek_savestate_changed callback for them after releasing the VCR mutex.
+ */
+static std::vector<size_t> vcr_store_seek_savestate(size_t frame, const std::vector<uint8_t>& buf)
+{
+    std::scoped_lock lock(vcr_mutex);
+
+    auto erased = vcr_erase_seek_savestate(frame);
+    std::erase(erased, frame);
+
+    std::optional<size_t> base_frame;
+    for (const auto& [key, st] : g_seek_savestates)
+    {
+        if (key < frame && st.base_frame == key && (!base_frame.has_value() || key > base_frame.value()))
+        {
+            base_frame = key;
+        }
+    }
+
+    if (g_core->cfg->seek_savestate_delta && base_frame.has_value())
+    {
+        auto delta = st_create_delta(vcr_get_keyframe_buffer(base_frame.value()), buf);
+
+        // Once the state diverged far enough from the keyframe, the delta isn't worth it anymore and we start a new keyframe
+        if (delta.size() <= buf.size() / 2)
+        {
+            g_core->log_info(std::format(L"[VCR] Stored seek savestate at frame {} as delta of size {} against frame {}", frame, delta.size(), base_frame.value()));
+            g_seek_savestates[frame] = vcr_make_seek_savestate(base_frame.value(), std::move(delta));
+            vcr_compress_seek_savestate_async(frame);
+            return erased;
+        }
+    }
+
+    g_seek_keyframe_cache = buf;
+    g_seek_keyframe_cache_frame = frame;
+    g_seek_savestates[frame] = vcr_make_seek_savestate(frame, std::vector(buf));
+    vcr_compress_seek_savestate_async(frame);
+    return erased;
 }
 
 void vcr_create_n_frame_savestate(size_t frame)
@@ -525,25 +1168,8 @@ void vcr_create_n_frame_savestate(size_t frame)
         }
     }
 
-    // If our seek savestate map is getting too large, we'll start purging the oldest ones (but not the first one!!!)
-    if (g_seek_savestates.size() > g_core->cfg->seek_savestate_max_count)
-    {
-        for (int32_t i = 1; i < g_header.length_samples; ++i)
-        {
-            if (g_seek_savestates.contains(i))
-            {
-                g_core->log_info(std::format(L"[VCR] Map too large! Purging seek savestate at frame {}...", i));
-                g_seek_savestates.erase(i);
-                g_core->callbacks.seek_savestate_changed((size_t)i);
-                break;
-            }
-        }
-    }
-
     g_core->log_info(std::format(L"[VCR] Creating seek savestate at frame {}...", frame));
     core_st_do_memory({}, core_st_job_save, [frame](const core_st_callback_info& info, const auto& buf) {
-        std::scoped_lock lock(vcr_mutex);
-
         if (info.result != Res_Ok)
         {
             g_core->show_dialog(std::format(L"Failed to save seek savestate at frame {}.", frame).c_str(), L"VCR", fsvc_error);
@@ -551,8 +1177,20 @@ void vcr_create_n_frame_savestate(size_t frame)
         }
 
         g_core->log_info(std::format(L"[VCR] Seek savestate at frame {} of size {} completed", frame, buf.size()));
-        g_seek_savestates[frame] = buf;
+
+        std::vector<size_t> evicted;
+        {
+            std::scoped_lock lock(vcr_mutex);
+            evicted = vcr_store_seek_savestate(frame, buf);
+            const auto over_limit = vcr_evict_seek_savestates();
+            evicted.insert(evicted.end(), over_limit.begin(), over_limit.end());
+        }
+
         g_core->callbacks.seek_savestate_changed((size_t)frame);
+        for (const auto victim : evicted)
+        {
+            g_core->callbacks.seek_savestate_changed(victim);
+        }
     },
                       false);
 }
@@ -651,6 +1289,7 @@ void vcr_handle_recording(int32_t index, core_buttons* input)
 
     if (!use_inputs_from_buffer)
     {
+        vcr_invalidate_input_snapshot(g_movie_inputs.size());
         g_movie_inputs.push_back(*input);
         g_header.length_samples++;
     }
@@ -924,6 +1563,7 @@ core_result core_vcr_start_record(std::filesystem::path path, uint16_t flags, st
     const core_vcr_movie_header default_hdr{};
     memset(&g_header, 0, sizeof(core_vcr_movie_header));
     g_movie_inputs = {};
+    vcr_invalidate_input_snapshot(0);
 
     g_header.magic = mup_magic;
     g_header.version = mup_version;
@@ -1031,6 +1671,9 @@ core_result core_vcr_replace_author_info(const std::filesystem::path& path, cons
     // We don't want to fopen with rb+ as it changes the last modified date, unless the author info actually needs to change, so
     // we skip that step if the values remain identical
 
+    // The movie might still be getting written to
+    vcr_wait_for_movie_writes();
+
     // 1. Read movie header
     const auto buf = read_file_buffer(path);
 
@@ -1110,6 +1753,7 @@ core_result vcr_stop_record()
     if (g_task == task_start_recording_from_reset)
     {
         g_task = task_idle;
+        vcr_wait_for_movie_writes();
         g_core->log_info(L"[VCR] Removing files (nothing recorded)");
         _unlink(std::filesystem::path(g_movie_path).replace_extension(".m64").string().c_str());
         _unlink(std::filesystem::path(g_movie_path).replace_extension(".st").string().c_str());
@@ -1119,6 +1763,11 @@ core_result vcr_stop_record()
     {
         write_movie();
 
+        if (!vcr_wait_for_movie_writes())
+        {
+            g_core->log_error(L"[VCR] Failed to write the movie file when stopping the recording");
+        }
+
         g_task = task_idle;
 
         g_core->log_info(std::format(L"[VCR] Recording stopped. Recorded %ld input samples", g_header.length_samples));
@@ -1164,6 +1813,9 @@ core_result core_vcr_start_playback(std::filesystem::path path)
 {
     std::unique_lock lock(vcr_mutex);
 
+    // The movie might still be getting written to
+    vcr_wait_for_movie_writes();
+
     auto movie_buf = read_file_buffer(path);
 
     if (movie_buf.empty())
@@ -1302,6 +1954,7 @@ core_result core_vcr_start_playback(std::filesystem::path path)
     m_current_vi = 0;
     g_movie_path = path;
     g_movie_inputs = movie_inputs;
+    vcr_invalidate_input_snapshot(0);
     g_header = header;
 
     if (header.startFlags & MOVIE_START_FROM_SNAPSHOT)
@@ -1482,7 +2135,7 @@ core_result vcr_begin_seek_impl(std::wstring str, bool pause_at_end, bool resume
 
             // NOTE: This needs to go through AsyncExecutor (despite us already being on a worker thread) or it will cause a deadlock.
             g_core->submit_task([=] {
-                core_st_do_memory(g_seek_savestates[closest_key], core_st_job_load, [=](const core_st_callback_info& info, auto buf) {
+                core_st_do_memory(vcr_get_seek_savestate_buffer(closest_key), core_st_job_load, [=](const core_st_callback_info& info, auto buf) {
                     if (info.result != Res_Ok)
                     {
                         g_core->show_dialog(L"Failed to load seek savestate for seek operation.", L"VCR", fsvc_error);
@@ -1534,10 +2187,14 @@ core_result vcr_begin_seek_impl(std::wstring str, bool pause_at_end, bool resume
                     to_erase.push_back(sample);
                 }
             }
+
+            // Erasing a keyframe erases its dependants too, but those are all after the target frame as well
+            std::ranges::sort(to_erase, std::greater<>());
+
             for (const auto sample : to_erase)
             {
                 g_core->log_info(std::format(L"[VCR] Erasing now-invalidated seek savestate at frame {}...", sample));
-                g_seek_savestates.erase(sample);
+                vcr_erase_seek_savestate(sample);
                 g_core->callbacks.seek_savestate_changed((size_t)sample);
             }
         }
@@ -1549,7 +2206,7 @@ core_result vcr_begin_seek_impl(std::wstring str, bool pause_at_end, bool resume
 
         // NOTE: This needs to go through AsyncExecutor (despite us already being on a worker thread) or it will cause a deadlock.
         g_core->submit_task([=] {
-            core_st_do_memory(g_seek_savestates[closest_key], core_st_job_load, [=](const core_st_callback_info& info, auto buf) {
+            core_st_do_memory(vcr_get_seek_savestate_buffer(closest_key), core_st_job_load, [=](const core_st_callback_info& info, auto buf) {
                 if (info.result != Res_Ok)
                 {
                     g_core->show_dialog(L"Failed to load seek savestate for seek operation.", L"VCR", fsvc_error);
@@ -1583,7 +2240,8 @@ core_result core_vcr_convert_freeze_buffer_to_movie(const core_vcr_freeze_info&
     header.startFlags = MOVIE_START_FROM_NOTHING;
     header.length_vis = UINT32_MAX;
     set_rom_info(&header);
-    inputs = freeze.input_buffer;
+    inputs.resize(freeze.input_buffer.size);
+    vcr_read_input_snapshot(freeze.input_buffer, inputs.data(), inputs.size());
     return Res_Ok;
 }
 
@@ -1649,6 +2307,8 @@ static void vcr_clear_seek_savestates()
     }
 
     g_seek_savestates.clear();
+    g_seek_keyframe_cache_frame.reset();
+    g_seek_keyframe_cache.clear();
 
     for (const auto frame : prev_seek_savestate_keys)
     {
@@ -1784,6 +2444,7 @@ core_result core_vcr_begin_warp_modify(const std::vector<core_buttons>& inputs)
         g_core->log_info(std::format(L"[VCR] First different frame is in the future (current sample: {}, first differenece: {}), copying inputs with no seek...", m_current_sample, g_warp_modify_first_difference_frame));
 
         g_movie_inputs = inputs;
+        vcr_invalidate_input_snapshot(g_warp_modify_first_difference_frame);
         g_header.length_samples = g_movie_inputs.size();
 
         g_warp_modify_active = true;
@@ -1807,6 +2468,7 @@ core_result core_vcr_begin_warp_modify(const std::vector<core_buttons>& inputs)
     g_warp_modify_active = true;
 
     g_movie_inputs = inputs;
+    vcr_invalidate_input_snapshot(g_warp_modify_first_difference_frame);
     g_header.length_samples = g_movie_inputs.size();
     g_core->log_info(std::format(L"[VCR] Warp modify started at frame {}", m_current_sample));
     g_core->callbacks.warp_modify_status_changed(g_warp_modify_active);
@@ -1828,6 +2490,8 @@ size_t core_vcr_get_warp_modify_first_difference_frame()
 
 void core_vcr_get_seek_savestate_frames(std::unordered_map<size_t, bool>& map)
 {
+    std::scoped_lock lock(vcr_mutex);
+
     map.clear();
 
     for (const auto& [key, _] : g_seek_savestates)
@@ -1838,6 +2502,7 @@ void core_vcr_get_seek_savestate_frames(std::unordered_map<size_t, bool>& map)
 
 bool core_vcr_has_seek_savestate_at_frame(const size_t frame)
 {
+    std::scoped_lock lock(vcr_mutex);
     return g_seek_savestates.contains(frame);
 }
 
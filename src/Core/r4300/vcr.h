@@ -28,3 +28,18 @@ bool allows_core_pause();
 bool is_frame_skipped();
 
 bool vcr_allows_core_pause();
+
+/**
+ * \brief Creates an input snapshot from a contiguous input buffer.
+ * \param inputs The inputs.
+ * \param count The amount of inputs.
+ */
+core_vcr_input_snapshot vcr_make_input_snapshot(const core_buttons* inputs, size_t count);
+
+/**
+ * \brief Copies inputs out of an input snapshot.
+ * \param snapshot The snapshot.
+ * \param inputs The buffer to copy the inputs into.
+ * \param count The amount of inputs to copy. Inputs past the end of the snapshot are zeroed.
+ */
+void vcr_read_input_snapshot(const core_vcr_input_snapshot& snapshot, core_buttons* inputs, size_t count);
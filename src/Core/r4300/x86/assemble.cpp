@@ -5,11 +5,11 @@
  */
 
 #include "stdafx.h"
+#include <r4300/code_cache.h>
 #include <r4300/macros.h>
 #include <r4300/recomph.h>
 #include <r4300/x86/assemble.h>
 #include <r4300/x86/regcache.h>
-#include <alloc.h>
 
 typedef struct _jump_table {
     uint32_t mi_addr;
@@ -83,7 +83,7 @@ inline void put8(unsigned char octet)
     if (code_length == max_code_length)
     {
         max_code_length += JUMP_TABLE_SIZE;
-        *inst_pointer = (unsigned char*)realloc_exec(*inst_pointer, code_length, max_code_length);
+        *inst_pointer = (unsigned char*)code_cache_realloc(*inst_pointer, code_length, max_code_length);
     }
 }
 
@@ -92,7 +92,7 @@ inline void put32(uint32_t dword)
     if ((code_length + 4) >= max_code_length)
     {
         max_code_length += JUMP_TABLE_SIZE;
-        *inst_pointer = (unsigned char*)realloc_exec(*inst_pointer, code_length, max_code_length);
+        *inst_pointer = (unsigned char*)code_cache_realloc(*inst_pointer, code_length, max_code_length);
     }
     *((uint32_t*)(&(*inst_pointer)[code_length])) = dword;
     code_length += 4;
@@ -103,7 +103,7 @@ inline void put16(uint16_t word)
     if ((code_length + 2) >= max_code_length)
     {
         max_code_length += JUMP_TABLE_SIZE;
-        *inst_pointer = (unsigned char*)realloc_exec(*inst_pointer, code_length, max_code_length);
+        *inst_pointer = (unsigned char*)code_cache_realloc(*inst_pointer, code_length, max_code_length);
     }
     *((uint16_t*)(&(*inst_pointer)[code_length])) = word;
     code_length += 2;
@@ -7,6 +7,7 @@
 #include "stdafx.h"
 #include <Core.h>
 #include <memory/memory.h>
+#include <r4300/code_cache.h>
 #include <r4300/interrupt.h>
 #include <r4300/macros.h>
 #include <r4300/ops.h>
@@ -1731,8 +1732,6 @@ void genswr()
     gencallinterp((uint32_t)SWR, 0);
 }
 
-#include <malloc.h>
-
 inline void put8gr(unsigned char octet)
 {
     (*inst_pointer)[code_length] = octet;
@@ -1740,7 +1739,7 @@ inline void put8gr(unsigned char octet)
     if (code_length == max_code_length)
     {
         max_code_length += JUMP_TABLE_SIZE;
-        *inst_pointer = (unsigned char*)realloc(*inst_pointer, max_code_length);
+        *inst_pointer = (unsigned char*)code_cache_realloc(*inst_pointer, max_code_length - JUMP_TABLE_SIZE, max_code_length);
     }
 }
 
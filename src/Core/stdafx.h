@@ -11,6 +11,7 @@
 #include <cctype>
 #include <cfloat>
 #include <cmath>
+#include <condition_variable>
 #include <csetjmp>
 #include <cstdarg>
 #include <cstdint>
@@ -777,15 +777,20 @@ static void handle_config_ini(const bool is_reading, mINI::INIStructure& ini)
     HANDLE_P_VALUE(capture_delay)
     HANDLE_VALUE(ffmpeg_final_options)
     HANDLE_VALUE(ffmpeg_path)
+    HANDLE_P_VALUE(ffmpeg_queue_depth)
     HANDLE_P_VALUE(synchronization_mode)
     HANDLE_P_VALUE(keep_default_working_directory)
     HANDLE_P_VALUE(fast_dispatcher)
+    HANDLE_P_VALUE(async_lua_callbacks)
     HANDLE_P_VALUE(plugin_discovery_delayed)
     HANDLE_VALUE(lua_script_path)
     HANDLE_VALUE(recent_lua_script_paths)
     HANDLE_P_VALUE(is_recent_scripts_frozen)
     HANDLE_P_VALUE(core.seek_savestate_interval)
     HANDLE_P_VALUE(core.seek_savestate_max_count)
+    HANDLE_P_VALUE(core.seek_savestate_delta)
+    HANDLE_P_VALUE(core.seek_savestate_codec)
+    HANDLE_P_VALUE(core.seek_savestate_max_size)
     HANDLE_P_VALUE(piano_roll_constrain_edit_to_column)
     HANDLE_P_VALUE(piano_roll_undo_stack_size)
     HANDLE_P_VALUE(piano_roll_keep_selection_visible)
@@ -795,7 +800,9 @@ static void handle_config_ini(const bool is_reading, mINI::INIStructure& ini)
     HANDLE_P_VALUE(core.wii_vc_emulation)
     HANDLE_P_VALUE(core.float_exception_emulation)
     HANDLE_P_VALUE(core.is_audio_delay_enabled)
+    HANDLE_P_VALUE(core.audio_update_timeout)
     HANDLE_P_VALUE(core.is_compiled_jump_enabled)
+    HANDLE_P_VALUE(core.code_cache_size)
     HANDLE_VALUE(selected_video_plugin)
     HANDLE_VALUE(selected_audio_plugin)
     HANDLE_VALUE(selected_input_plugin)
@@ -819,6 +826,7 @@ static void handle_config_ini(const bool is_reading, mINI::INIStructure& ini)
     HANDLE_P_VALUE(core.vcr_readonly)
     HANDLE_P_VALUE(core.vcr_backups)
     HANDLE_P_VALUE(core.vcr_write_extended_format)
+    HANDLE_P_VALUE(core.vcr_fsync)
     HANDLE_P_VALUE(automatic_update_checking)
     HANDLE_P_VALUE(silent_mode)
     HANDLE_P_VALUE(core.max_lag)
@@ -280,6 +280,11 @@ struct t_config {
     /// </summary>
     std::wstring ffmpeg_path = L"C:\\ffmpeg\\bin\\ffmpeg.exe";
 
+    /// <summary>
+    /// The amount of video frames which can be queued up for FFmpeg before emulation waits for it to catch up
+    /// </summary>
+    int32_t ffmpeg_queue_depth = 8;
+
     /// <summary>
     /// The audio-video synchronization mode
     /// <para/>
@@ -299,6 +304,12 @@ struct t_config {
     /// </summary>
     int32_t fast_dispatcher = 1;
 
+    /// <summary>
+    /// Whether event callbacks other than atinput, atwindowmessage and the drawing callbacks are delivered without the emulation thread waiting for them to complete.
+    /// Memory writes, savestate operations and pauses from such callbacks race the emulation thread, which makes playback nondeterministic, so this is opt-in.
+    /// </summary>
+    int32_t async_lua_callbacks = 0;
+
     /// <summary>
     /// Whether the plugin discovery process is artificially lengthened.
     /// </summary>
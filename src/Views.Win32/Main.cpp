@@ -520,6 +520,10 @@ void update_screen()
 
 void at_vi()
 {
+#ifdef VIEW_BENCHMARK_SUPPORT
+    Benchmark::vi();
+#endif
+
     if (!EncodingManager::is_capturing())
     {
         return;
@@ -567,26 +571,6 @@ void update_titlebar()
     SetWindowText(g_main_hwnd, text.c_str());
 }
 
-/**
- * \brief Computes the average rate of entries in the time queue per second (e.g.: FPS from frame deltas)
- * \param times A circular buffer of deltas
- * \return The average rate per second from the delta in the queue
- */
-static double get_rate_per_second_from_deltas(const std::span<core_timer_delta>& times)
-{
-    size_t count = 0;
-    double sum = 0.0;
-    for (const auto& time : times)
-    {
-        if (time.count() > 0.0)
-        {
-            sum += time.count() / 1000000.0;
-            count++;
-        }
-    }
-    return count > 0 ? 1000.0 / (sum / count) : 0.0;
-}
-
 #pragma region Change notifications
 
 void on_script_started(std::any data)
@@ -2117,16 +2101,10 @@ static void CALLBACK invalidate_callback(UINT, UINT, DWORD_PTR, DWORD_PTR, DWORD
     // We throttle FPS and VI/s visual updates to 1 per second, so no unstable values are displayed
     if (time - last_statusbar_update > std::chrono::seconds(1))
     {
-        g_core.g_frame_deltas_mutex.lock();
-        auto fps = get_rate_per_second_from_deltas(g_core.g_frame_deltas);
-        g_core.g_frame_deltas_mutex.unlock();
-
-        g_core.g_vi_deltas_mutex.lock();
-        auto vis = get_rate_per_second_from_deltas(g_core.g_vi_deltas);
-        g_core.g_vi_deltas_mutex.unlock();
+        const auto timer_info = core_vr_get_timer_info();
 
-        Statusbar::post(std::format(L"FPS: {:.1f}", fps), Statusbar::Section::FPS);
-        Statusbar::post(std::format(L"VI/s: {:.1f}", vis), Statusbar::Section::VIs);
+        Statusbar::post(std::format(L"FPS: {:.1f}", timer_info.frame.rate), Statusbar::Section::FPS);
+        Statusbar::post(std::format(L"VI/s: {:.1f}", timer_info.vi.rate), Statusbar::Section::VIs);
 
         last_statusbar_update = time;
     }
@@ -2278,6 +2256,7 @@ static core_result init_core()
     g_core.callbacks.debugger_cpu_state_changed = [](core_dbg_cpu_state* value) {
         Messenger::broadcast(Messenger::Message::DebuggerCpuStateChanged, value);
     };
+    g_core.callbacks.debugger_watch_hit = LuaCallbacks::call_watch_hit;
     g_core.callbacks.lag_limit_exceeded = []() {
         Messenger::broadcast(Messenger::Message::LagLimitExceeded, nullptr);
     };
@@ -2364,6 +2343,9 @@ static void main_dispatcher_init()
             return;
         }
         SendMessage(g_main_hwnd, WM_EXECUTE_DISPATCHER, 0, 0);
+    },
+    [] {
+        PostMessage(g_main_hwnd, WM_EXECUTE_DISPATCHER, 0, 0);
     });
 }
 
@@ -35,6 +35,9 @@ namespace EncodingManager
     int32_t m_video_height;
 
     std::atomic m_capturing = false;
+
+    // The movie VI from which on no more data is appended to the capture, or -1 if there's no such limit
+    std::atomic<int32_t> m_end_vi = -1;
     t_config::EncoderType m_encoder_type;
     std::unique_ptr<Encoder> m_encoder;
     std::recursive_mutex m_mutex;
@@ -421,6 +424,11 @@ namespace EncodingManager
             Sleep(g_config.capture_delay);
         }
 
+        if (m_end_vi != -1 && core_vcr_get_current_vi() >= m_end_vi)
+        {
+            return;
+        }
+
         read_screen();
 
         if (m_encoder->append_video(m_video_buf))
@@ -454,6 +462,11 @@ namespace EncodingManager
         if (ai_len <= 0)
             return;
 
+        if (m_end_vi != -1 && core_vcr_get_current_vi() >= m_end_vi)
+        {
+            return;
+        }
+
         if (!m_encoder->append_audio(reinterpret_cast<uint8_t*>(buf), ai_len, m_audio_bitrate))
         {
             DialogService::show_dialog(
@@ -507,6 +520,11 @@ namespace EncodingManager
         return m_capturing;
     }
 
+    void set_end_vi(int32_t vi)
+    {
+        m_end_vi = vi;
+    }
+
     void init()
     {
         Messenger::subscribe(Messenger::Message::DacrateChanged, ai_dacrate_changed);
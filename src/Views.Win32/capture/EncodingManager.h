@@ -61,6 +61,13 @@ namespace EncodingManager
      */
     void stop_capture(const std::function<void(bool)>& callback = nullptr);
 
+    /**
+     * \brief Sets the movie VI from which on video and audio data is no longer appended to the capture.
+     * \param vi The VI, or -1 to append data until the capture is stopped.
+     * \remarks This method is thread-safe. Used to end a capture at an exact point without having to wait for it to stop.
+     */
+    void set_end_vi(int32_t vi);
+
     /**
      * \brief Notifies the encoding manager of a new VI
      */
@@ -9,6 +9,15 @@
 #include <DialogService.h>
 #include <Config.h>
 
+// The smallest allowed video queue depth, so the writer thread can drain one frame while the next one is being queued
+constexpr size_t MIN_QUEUE_DEPTH = 2;
+
+// How long a push waits for the writer thread to free up space before trying to unblock ffmpeg
+constexpr auto STALL_TIMEOUT = std::chrono::seconds(2);
+
+// How long a push waits for the writer thread in total before failing the capture
+constexpr auto STALL_LIMIT = std::chrono::seconds(30);
+
 std::optional<std::wstring> FFmpegEncoder::start(Params params)
 {
     m_params = params;
@@ -18,10 +27,28 @@ std::optional<std::wstring> FFmpegEncoder::start(Params params)
 
     g_view_logger->info("[FFmpegEncoder] arate: {}, bufsize_video: {}, bufsize_audio: {}\n", m_params.arate, bufsize_video, bufsize_audio);
 
+    // The audio queue holds one second of 16-bit stereo samples, plus as much as the video queue can hold
+    const size_t depth = std::max((size_t)std::max(g_config.ffmpeg_queue_depth, 0), MIN_QUEUE_DEPTH);
+    m_frame_size = m_params.width * m_params.height * 3;
+    m_video_queue.capacity = m_frame_size * depth;
+    m_audio_queue.capacity = std::max((size_t)m_params.arate, (size_t)1) * 4 * (1 + depth / std::max(m_params.fps, 1u));
+
+    m_video_queue.buffer = static_cast<uint8_t*>(malloc(m_video_queue.capacity));
+    m_audio_queue.buffer = static_cast<uint8_t*>(malloc(m_audio_queue.capacity));
+
+    if (!m_video_queue.buffer || !m_audio_queue.buffer)
+    {
+        free(m_video_queue.buffer);
+        free(m_audio_queue.buffer);
+        m_video_queue.buffer = nullptr;
+        m_audio_queue.buffer = nullptr;
+        return std::format(L"Failed to allocate {} MB for the capture queues. Try lowering the FFmpeg queue depth.", (m_video_queue.capacity + m_audio_queue.capacity) / 1024 / 1024);
+    }
+
 #define VIDEO_PIPE_NAME L"\\\\.\\pipe\\mupenvideo"
 #define AUDIO_PIPE_NAME L"\\\\.\\pipe\\mupenaudio"
 
-    m_video_pipe = CreateNamedPipe(
+    m_video_queue.pipe = CreateNamedPipe(
     VIDEO_PIPE_NAME,
     PIPE_ACCESS_OUTBOUND,
     PIPE_TYPE_BYTE | PIPE_WAIT,
@@ -31,12 +58,14 @@ std::optional<std::wstring> FFmpegEncoder::start(Params params)
     0,
     nullptr);
 
-    if (!m_video_pipe)
+    if (!m_video_queue.pipe)
     {
+        free(m_video_queue.buffer);
+        free(m_audio_queue.buffer);
         return L"Failed to create video pipe.";
     }
 
-    m_audio_pipe = CreateNamedPipe(
+    m_audio_queue.pipe = CreateNamedPipe(
     AUDIO_PIPE_NAME,
     PIPE_ACCESS_OUTBOUND,
     PIPE_TYPE_BYTE | PIPE_WAIT,
@@ -46,9 +75,11 @@ std::optional<std::wstring> FFmpegEncoder::start(Params params)
     0,
     nullptr);
 
-    if (!m_audio_pipe)
+    if (!m_audio_queue.pipe)
     {
-        CloseHandle(m_video_pipe);
+        CloseHandle(m_video_queue.pipe);
+        free(m_video_queue.buffer);
+        free(m_audio_queue.buffer);
         return L"Failed to create audio pipe.";
     }
 
@@ -83,198 +114,230 @@ std::optional<std::wstring> FFmpegEncoder::start(Params params)
     {
 
         g_view_logger->info(L"CreateProcess failed ({}).", GetLastError());
-        CloseHandle(m_video_pipe);
-        CloseHandle(m_audio_pipe);
+        CloseHandle(m_video_queue.pipe);
+        CloseHandle(m_audio_queue.pipe);
+        free(m_video_queue.buffer);
+        free(m_audio_queue.buffer);
         return std::format(L"Failed to start ffmpeg process! Does ffmpeg exist on disk at '{}'?", g_config.ffmpeg_path);
     }
 
-    m_silence_buffer = static_cast<uint8_t*>(calloc(params.arate, 1));
-    m_blank_buffer = static_cast<uint8_t*>(calloc(m_params.width * m_params.height * 3, 1));
-    m_dropped_frames = 0;
-
-    m_video_thread = std::thread(&FFmpegEncoder::write_video_thread, this);
-    m_audio_thread = std::thread(&FFmpegEncoder::write_audio_thread, this);
+    m_video_queue.thread = std::thread(&FFmpegEncoder::write_thread, std::ref(m_video_queue));
+    m_audio_queue.thread = std::thread(&FFmpegEncoder::write_thread, std::ref(m_audio_queue));
 
     Sleep(500);
 
     return std::nullopt;
 }
 
-bool FFmpegEncoder::stop()
+void FFmpegEncoder::stop_queue(t_pipe_queue& queue)
 {
-    m_stop_thread = true;
-    m_video_cv.notify_all();
-    m_audio_cv.notify_all();
-
-    // HACK: Give it some time to maybe accept the last writes...
-    Sleep(500);
-
-    CancelIo(m_video_pipe);
-    CancelIo(m_audio_pipe);
-    DisconnectNamedPipe(m_video_pipe);
-    DisconnectNamedPipe(m_audio_pipe);
-
-    WaitForSingleObject(m_pi.hProcess, INFINITE);
-    CloseHandle(m_pi.hProcess);
-    CloseHandle(m_pi.hThread);
-    m_audio_thread.join();
-    m_video_thread.join();
-
-    if (!this->m_video_queue.empty() || !this->m_audio_queue.empty())
     {
-        DialogService::show_dialog(std::format(L"Capture stopped with {} video, {} audio elements remaining in queue!\nThe capture might be corrupted.", this->m_video_queue.size(), this->m_audio_queue.size()).c_str(), L"FFmpeg");
+        std::lock_guard lock(queue.mutex);
+        queue.stop = true;
     }
+    queue.cv.notify_all();
 
-    if (m_dropped_frames > 0)
+    // A writer which ffmpeg stopped reading from is stuck in its pipe write
+    if (queue.failed)
     {
-        DialogService::show_dialog(std::format(L"{} frames were dropped during capture to avoid out-of-memory errors.\nThe capture might contain empty frames.", m_dropped_frames).c_str(), L"FFmpeg");
+        CancelSynchronousIo(queue.thread.native_handle());
     }
+    queue.thread.join();
 
-    free(m_silence_buffer);
-    free(m_blank_buffer);
-    return true;
-}
-
-static bool write_pipe_checked(const HANDLE pipe, const char* buffer, const unsigned buffer_size, const bool is_video)
-{
-    DWORD written = 0;
-    const auto result = WriteFile(pipe, buffer, buffer_size, &written, nullptr);
-    if (written != buffer_size || !result)
+    // Disconnecting discards whatever ffmpeg hasn't read yet, so we wait for it to catch up first
+    if (!queue.failed)
     {
-        // g_view_logger->error("[FFmpegEncoder] Error writing to {} pipe, error code {}", is_video ? "video" : "audio", GetLastError());
-        return false;
+        FlushFileBuffers(queue.pipe);
     }
-
-    return true;
+    DisconnectNamedPipe(queue.pipe);
+    CloseHandle(queue.pipe);
 }
 
-bool FFmpegEncoder::append_audio_impl(uint8_t* audio, size_t length)
+bool FFmpegEncoder::stop()
 {
-    uint8_t* buf = m_silence_buffer;
-    if (audio != m_silence_buffer)
-    {
-        buf = static_cast<uint8_t*>(malloc(length));
-        memcpy(buf, audio, length);
-    }
+    stop_queue(m_video_queue);
+    stop_queue(m_audio_queue);
 
-    m_last_write_was_video = false;
+    WaitForSingleObject(m_pi.hProcess, INFINITE);
+    CloseHandle(m_pi.hProcess);
+    CloseHandle(m_pi.hThread);
 
+    g_view_logger->info("[FFmpegEncoder] Video queue: {} writes, peak depth {}/{} frames, stalled for {}ms",
+                        m_video_queue.writes,
+                        (m_video_queue.peak_size + m_frame_size - 1) / m_frame_size,
+                        m_video_queue.capacity / m_frame_size,
+                        std::chrono::duration_cast<std::chrono::milliseconds>(m_video_queue.stall_time).count());
+    g_view_logger->info("[FFmpegEncoder] Audio queue: {} writes, peak depth {}/{} bytes, stalled for {}ms",
+                        m_audio_queue.writes,
+                        m_audio_queue.peak_size,
+                        m_audio_queue.capacity,
+                        std::chrono::duration_cast<std::chrono::milliseconds>(m_audio_queue.stall_time).count());
+
+    if (m_video_queue.failed || m_audio_queue.failed)
     {
-        std::lock_guard lock(m_audio_queue_mutex);
-        this->m_audio_queue.emplace(buf, length);
+        DialogService::show_dialog(std::format(L"FFmpeg stopped accepting {} data during capture.\nThe capture might be incomplete.", m_video_queue.failed ? L"video" : L"audio").c_str(), L"FFmpeg");
     }
-    m_audio_cv.notify_one();
 
+    free(m_video_queue.buffer);
+    free(m_audio_queue.buffer);
     return true;
 }
 
-bool FFmpegEncoder::append_video(uint8_t* image)
+static bool write_pipe_checked(const HANDLE pipe, const uint8_t* buffer, const size_t buffer_size)
 {
-    if (g_config.synchronization_mode == 1)
+    DWORD written = 0;
+    const auto result = WriteFile(pipe, buffer, (DWORD)buffer_size, &written, nullptr);
+    return result && written == buffer_size;
+}
+
+bool FFmpegEncoder::push(t_pipe_queue& queue, const uint8_t* data, size_t length, t_pipe_queue* pad_queue, size_t pad_length)
+{
+    std::unique_lock lock(queue.mutex);
+
+    while (length > 0)
     {
-        if (m_last_write_was_video)
+        if (queue.size == queue.capacity && !queue.failed)
         {
-            return true;
+            const auto start = std::chrono::steady_clock::now();
+            while (!queue.cv.wait_for(lock, STALL_TIMEOUT, [&] {
+                return queue.size < queue.capacity || queue.failed;
+            }))
+            {
+                if (std::chrono::steady_clock::now() - start >= STALL_LIMIT)
+                {
+                    g_view_logger->error("[FFmpegEncoder] FFmpeg stopped reading from the pipe, stopping the capture");
+                    queue.failed = true;
+                    break;
+                }
+
+                // ffmpeg interleaves reads from both pipes, so it stops draining this one when the other one runs dry, e.g. because the game stopped producing audio
+                if (!pad_queue)
+                {
+                    continue;
+                }
+
+                bool starving;
+                {
+                    std::scoped_lock pad_lock(pad_queue->mutex);
+                    starving = pad_queue->size == 0 && !pad_queue->failed;
+                }
+
+                if (starving)
+                {
+                    g_view_logger->info("[FFmpegEncoder] Padding the other pipe with {} bytes of silence", pad_length);
+                    lock.unlock();
+                    push(*pad_queue, nullptr, pad_length);
+                    lock.lock();
+                }
+            }
+            queue.stall_time += std::chrono::steady_clock::now() - start;
         }
-    }
-    else if (g_config.synchronization_mode == 2)
-    {
-        if (core_vr_get_lag_count() > 2)
+
+        if (queue.failed)
         {
-            const auto samples_per_frame = static_cast<double>(m_params.arate) / 64;
-            append_audio_impl(m_silence_buffer, static_cast<size_t>(round(samples_per_frame)));
+            return false;
         }
-    }
-
-    m_last_write_was_video = true;
-
-    auto buf = static_cast<uint8_t*>(malloc(m_params.width * m_params.height * 3));
 
-    // HACK: If we run out of memory, we start writing empty video frames
-    // This can happen when encoding at high resolutions, as ffmpeg might not start processing the pipe writes in time
-    if (!buf)
-    {
-        g_view_logger->error("[FFmpegEncoder] Out of memory, writing blank video frame");
-        ++m_dropped_frames;
+        // The writer thread never touches the free part of the ring, so we can fill it without holding the lock
+        const size_t write = (queue.read + queue.size) % queue.capacity;
+        const size_t chunk = std::min({length, queue.capacity - queue.size, queue.capacity - write});
+        lock.unlock();
 
+        if (data)
         {
-            std::lock_guard lock(m_video_queue_mutex);
-            m_video_queue.emplace(m_blank_buffer, false);
+            memcpy(queue.buffer + write, data, chunk);
+            data += chunk;
         }
-        m_video_cv.notify_one();
-        return true;
-    }
-
-    memcpy(buf, image, m_params.width * m_params.height * 3);
+        else
+        {
+            memset(queue.buffer + write, 0, chunk);
+        }
+        length -= chunk;
 
-    {
-        std::lock_guard lock(m_video_queue_mutex);
-        m_video_queue.emplace(buf, true);
+        lock.lock();
+        queue.size += chunk;
+        queue.peak_size = std::max(queue.peak_size, queue.size);
+        queue.cv.notify_all();
     }
-    m_video_cv.notify_one();
 
     return true;
 }
 
-bool FFmpegEncoder::append_audio(uint8_t* audio, size_t length, uint8_t)
+void FFmpegEncoder::write_thread(t_pipe_queue& queue)
 {
-    auto buf = static_cast<uint8_t*>(malloc(length));
-    memcpy(buf, audio, length);
-
-    return append_audio_impl(buf, length);
-}
+    // Writing at most half of the ring at once lets the producer refill the other half in the meantime
+    const size_t max_batch = std::max(queue.capacity / 2, (size_t)1);
 
-void FFmpegEncoder::write_audio_thread()
-{
-    g_view_logger->trace("[FFmpegEncoder] Audio thread ready");
+    std::unique_lock lock(queue.mutex);
 
-    while (!this->m_stop_thread)
+    while (true)
     {
-        std::unique_lock lock(m_audio_queue_mutex);
-        m_audio_cv.wait(lock, [this] {
-            return !m_audio_queue.empty() || m_stop_thread;
+        queue.cv.wait(lock, [&] {
+            return queue.size > 0 || queue.stop;
         });
 
-        if (this->m_audio_queue.empty())
-            continue;
+        if (queue.size == 0)
+        {
+            break;
+        }
 
-        auto tuple = this->m_audio_queue.front();
-        this->m_audio_queue.pop();
+        // OPTIMIZATION: Write everything that's queued up to the wrap point in one go instead of issuing one write per frame or audio chunk
+        const size_t chunk = std::min({queue.size, queue.capacity - queue.read, max_batch});
+        const uint8_t* data = queue.buffer + queue.read;
         lock.unlock();
 
-        const auto buf = std::get<0>(tuple);
-        const auto len = std::get<1>(tuple);
+        const bool success = write_pipe_checked(queue.pipe, data, chunk);
 
-        write_pipe_checked(m_audio_pipe, (char*)buf, len, false);
-        if (buf != m_silence_buffer)
+        lock.lock();
+        ++queue.writes;
+
+        if (!success)
         {
-            free(buf);
+            g_view_logger->error("[FFmpegEncoder] Error writing to pipe, error code {}", GetLastError());
+            queue.failed = true;
+            queue.size = 0;
+            queue.cv.notify_all();
+            break;
         }
+
+        queue.read = (queue.read + chunk) % queue.capacity;
+        queue.size -= chunk;
+        queue.cv.notify_all();
     }
 }
 
-void FFmpegEncoder::write_video_thread()
+bool FFmpegEncoder::append_video(uint8_t* image)
 {
-    g_view_logger->trace("[FFmpegEncoder] Video thread ready");
-
-    while (!this->m_stop_thread)
+    if (g_config.synchronization_mode == 1)
     {
-        std::unique_lock lock(m_video_queue_mutex);
-        m_video_cv.wait(lock, [this] {
-            return !m_video_queue.empty() || m_stop_thread;
-        });
-
-        if (m_video_queue.empty())
-            continue;
-
-        auto pair = this->m_video_queue.front();
-        this->m_video_queue.pop();
-        lock.unlock();
-
-        write_pipe_checked(m_video_pipe, (char*)pair.first, m_params.width * m_params.height * 3, true);
-        if (pair.second)
+        if (m_last_write_was_video)
+        {
+            return true;
+        }
+    }
+    else if (g_config.synchronization_mode == 2)
+    {
+        if (core_vr_get_lag_count() > 2)
         {
-            free(pair.first);
+            const auto samples_per_frame = static_cast<double>(m_params.arate) / 64;
+            if (!push(m_audio_queue, nullptr, static_cast<size_t>(round(samples_per_frame))))
+            {
+                return false;
+            }
         }
     }
+
+    m_last_write_was_video = true;
+
+    // If ffmpeg falls behind, this blocks until a slot frees up instead of growing the queue or dropping the frame.
+    // If the audio pipe runs dry meanwhile, it's padded with enough silence for ffmpeg to drain the whole video queue
+    const size_t silence_per_frame = (size_t)m_params.arate / std::max(m_params.fps, 1u) * 4;
+    const size_t silence = std::min(silence_per_frame * (m_video_queue.capacity / m_frame_size), m_audio_queue.capacity);
+    return push(m_video_queue, image, m_frame_size, &m_audio_queue, silence);
+}
+
+bool FFmpegEncoder::append_audio(uint8_t* audio, size_t length, uint8_t)
+{
+    m_last_write_was_video = false;
+    return push(m_audio_queue, audio, length);
 }
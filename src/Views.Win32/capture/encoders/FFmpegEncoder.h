@@ -16,31 +16,58 @@ public:
     bool append_audio(uint8_t* audio, size_t length, uint8_t bitrate) override;
 
 private:
-    bool append_audio_impl(uint8_t* audio, size_t length);
-    void write_video_thread();
-    void write_audio_thread();
+    /**
+     * \brief A fixed-capacity byte queue feeding one of the ffmpeg pipes from its own writer thread.
+     */
+    struct t_pipe_queue {
+        /// The pipe the queue is drained into.
+        HANDLE pipe{};
+        /// The ring buffer, allocated once when encoding starts.
+        uint8_t* buffer{};
+        /// The ring buffer's size in bytes.
+        size_t capacity{};
+        /// The offset of the oldest queued byte.
+        size_t read{};
+        /// The amount of queued bytes.
+        size_t size{};
+        /// Whether the writer thread should exit once the queue is drained.
+        bool stop{};
+        /// Whether a pipe write failed. All further pushes fail.
+        bool failed{};
+
+        /// The highest amount of bytes queued at once.
+        size_t peak_size{};
+        /// The time producers spent waiting for the writer thread to free up space.
+        std::chrono::nanoseconds stall_time{};
+        /// The amount of pipe writes issued.
+        size_t writes{};
+
+        std::mutex mutex{};
+        std::condition_variable cv{};
+        std::thread thread{};
+    };
+
+    /**
+     * \brief Copies data into a queue, waiting for the writer thread to free up space if needed.
+     * \param queue The queue.
+     * \param data The data, or nullptr to push silence.
+     * \param length The data's length in bytes.
+     * \param pad_queue The queue to pad with silence when ffmpeg stops draining this one while it's empty, or nullptr.
+     * \param pad_length The amount of silence to pad <c>pad_queue</c> with at once, in bytes.
+     * \return Whether the operation succeeded. Fails if a write to the queue's pipe failed or ffmpeg stopped draining the queue.
+     */
+    static bool push(t_pipe_queue& queue, const uint8_t* data, size_t length, t_pipe_queue* pad_queue = nullptr, size_t pad_length = 0);
+    static void write_thread(t_pipe_queue& queue);
+    static void stop_queue(t_pipe_queue& queue);
 
     Params m_params{};
 
     STARTUPINFO m_si{};
     PROCESS_INFORMATION m_pi{};
-    HANDLE m_video_pipe{};
-    HANDLE m_audio_pipe{};
 
-    uint8_t* m_silence_buffer{};
-    uint8_t* m_blank_buffer{};
-    size_t m_dropped_frames = 0;
-
-    bool m_stop_thread = false;
+    size_t m_frame_size{};
     bool m_last_write_was_video = false;
 
-    std::thread m_audio_thread;
-    std::mutex m_audio_queue_mutex{};
-    std::condition_variable m_audio_cv{};
-    std::queue<std::tuple<uint8_t*, size_t>> m_audio_queue;
-
-    std::thread m_video_thread;
-    std::mutex m_video_queue_mutex{};
-    std::condition_variable m_video_cv{};
-    std::queue<std::pair<uint8_t*, bool>> m_video_queue;
+    t_pipe_queue m_video_queue{};
+    t_pipe_queue m_audio_queue{};
 };
@@ -5,27 +5,88 @@
  */
 
 #include "stdafx.h"
+#include <Config.h>
 #include <json.hpp>
 #include <components/Benchmark.h>
 
+static bool running{};
 static size_t frames{};
+static std::atomic<size_t> vis{};
 static std::chrono::time_point<std::chrono::high_resolution_clock> start_time;
+static std::chrono::time_point<std::chrono::high_resolution_clock> last_frame_time;
+static std::vector<std::chrono::nanoseconds> frame_times;
+
+/**
+ * \brief Gets the value at the specified percentile of a sorted vector.
+ */
+static double percentile(const std::vector<std::chrono::nanoseconds>& sorted, const double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    const auto index = std::min(sorted.size() - 1, (size_t)(p / 100.0 * sorted.size()));
+    return (double)sorted[index].count() / 1000000.0;
+}
 
 void Benchmark::start()
 {
+    frames = 0;
+    vis = 0;
+    frame_times.clear();
+    frame_times.reserve(100000);
     start_time = std::chrono::high_resolution_clock::now();
+    last_frame_time = start_time;
+    running = true;
 }
 
 void Benchmark::stop(t_result* result)
 {
+    running = false;
+
     const auto now = std::chrono::high_resolution_clock::now();
-    result->fps = (double)frames / ((double)std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_time).count() / 1000000000.0);
+    const double seconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_time).count() / 1000000000.0;
+
+    result->core_type = g_config.core.core_type;
+#ifdef _M_X64
+    // There's no 64-bit recompiler, so the core runs the cached interpreter instead and the result must say so
+    if (result->core_type == 1)
+    {
+        result->core_type = 0;
+    }
+#endif
+    result->frames = frames;
+    result->vis = vis;
+    result->fps = (double)frames / seconds;
+    result->vis_per_second = (double)vis / seconds;
+
+    auto sorted_frame_times = frame_times;
+    std::ranges::sort(sorted_frame_times);
+    result->frame_time_p50 = percentile(sorted_frame_times, 50);
+    result->frame_time_p95 = percentile(sorted_frame_times, 95);
+    result->frame_time_p99 = percentile(sorted_frame_times, 99);
+
+    PROCESS_MEMORY_COUNTERS pmc{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    {
+        result->peak_rss = pmc.PeakWorkingSetSize;
+    }
 }
 
 void Benchmark::save_result_to_file(const std::filesystem::path& path, const t_result& result)
 {
     nlohmann::json j;
+    j["core_type"] = result.core_type;
+    j["frames"] = result.frames;
+    j["vis"] = result.vis;
     j["fps"] = result.fps;
+    j["vis_per_second"] = result.vis_per_second;
+    j["frame_time_p50"] = result.frame_time_p50;
+    j["frame_time_p95"] = result.frame_time_p95;
+    j["frame_time_p99"] = result.frame_time_p99;
+    j["peak_rss"] = result.peak_rss;
+    j["st_save_time"] = result.st_save_time;
+    j["st_load_time"] = result.st_load_time;
 
     std::ofstream of(path);
     of << j.dump(4);
@@ -34,5 +95,23 @@ void Benchmark::save_result_to_file(const std::filesystem::path& path, const t_r
 
 void Benchmark::frame()
 {
+    if (!running)
+    {
+        return;
+    }
+
+    const auto now = std::chrono::high_resolution_clock::now();
+    frame_times.push_back(now - last_frame_time);
+    last_frame_time = now;
     frames++;
 }
+
+void Benchmark::vi()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    ++vis;
+}
@@ -12,7 +12,28 @@
 namespace Benchmark
 {
     typedef struct {
+        /// The core type the benchmark ran with.
+        int32_t core_type;
+
+        /// The amount of frames and VIs emulated during the benchmark.
+        size_t frames;
+        size_t vis;
+
+        /// The average amount of frames and VIs emulated per second.
         double fps;
+        double vis_per_second;
+
+        /// Frame time percentiles in milliseconds.
+        double frame_time_p50;
+        double frame_time_p95;
+        double frame_time_p99;
+
+        /// The process' peak resident memory in bytes.
+        size_t peak_rss;
+
+        /// The duration of a savestate save and load in milliseconds, or -1 if not measured.
+        double st_save_time = -1;
+        double st_load_time = -1;
     } t_result;
 
     /**
@@ -36,4 +57,9 @@ namespace Benchmark
      * \brief Notifies about a new frame.
      */
     void frame();
+
+    /**
+     * \brief Notifies about a new VI.
+     */
+    void vi();
 } // namespace Benchmark
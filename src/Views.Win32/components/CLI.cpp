@@ -16,6 +16,7 @@
 #include <components/CLI.h>
 #include <components/Compare.h>
 #include <components/Dispatcher.h>
+#include <components/ParallelDump.h>
 #include <lua/LuaConsole.h>
 
 struct t_cli_params {
@@ -27,6 +28,9 @@ struct t_cli_params {
     std::filesystem::path benchmark{};
     bool close_on_movie_end{};
     bool wait_for_debugger{};
+    size_t parallel_dump{};
+    std::filesystem::path segment_st{};
+    int32_t segment_end_vi = -1;
 };
 
 struct t_cli_state {
@@ -34,6 +38,7 @@ struct t_cli_state {
     bool is_movie_from_start{};
     size_t dacrate_change_count{};
     bool first_emu_launched = true;
+    bool segment_ended{};
 };
 
 static t_cli_params cli_params{};
@@ -50,6 +55,9 @@ static void log_cli_params(const t_cli_params& params)
     g_view_logger->trace("  benchmark: {}", params.benchmark.string());
     g_view_logger->trace("  close_on_movie_end: {}", params.close_on_movie_end);
     g_view_logger->trace("  wait_for_debugger: {}", params.wait_for_debugger);
+    g_view_logger->trace("  parallel_dump: {}", params.parallel_dump);
+    g_view_logger->trace("  segment_st: {}", params.segment_st.string());
+    g_view_logger->trace("  segment_end_vi: {}", params.segment_end_vi);
 }
 
 static void start_rom()
@@ -113,12 +121,76 @@ static void start_lua()
 
 static void start_capture()
 {
-    if (cli_params.avi.empty())
+    if (cli_params.avi.empty() || ParallelDump::active())
     {
         return;
     }
 
-    EncodingManager::start_capture(cli_params.avi.string().c_str(), static_cast<t_config::EncoderType>(g_config.encoder_type), false);
+    EncodingManager::set_end_vi(cli_params.segment_end_vi);
+
+    if (cli_params.segment_st.empty())
+    {
+        EncodingManager::start_capture(cli_params.avi.string().c_str(), static_cast<t_config::EncoderType>(g_config.encoder_type), false);
+        return;
+    }
+
+    // Loading the savestate in read-write mode would truncate the movie and continue recording it, so the workers must play it back read-only
+    g_config.core.vcr_readonly = true;
+
+    // The segment's savestate must be loaded before the first frame is captured, so emulation is held until both the load and the capture start are done
+    core_vr_wait_increment();
+    core_st_do_file(cli_params.segment_st, core_st_job_load, [](const core_st_callback_info& info, auto) {
+        if (info.result != Res_Ok)
+        {
+            g_view_logger->error("[CLI] Failed to load segment savestate");
+            core_vr_wait_decrement();
+            PostMessage(g_main_hwnd, WM_CLOSE, 0, 0);
+            return;
+        }
+
+        EncodingManager::start_capture(cli_params.avi.string().c_str(), static_cast<t_config::EncoderType>(g_config.encoder_type), false, [](auto) {
+            core_vr_wait_decrement();
+        });
+    },
+                    true);
+}
+
+static void finish_benchmark(const Benchmark::t_result& result)
+{
+    Benchmark::save_result_to_file(cli_params.benchmark, result);
+    PostMessage(g_main_hwnd, WM_CLOSE, 0, 0);
+}
+
+/**
+ * \brief Performs a savestate save-load roundtrip, writes the durations into the benchmark result and finishes the benchmark.
+ */
+static void measure_savestate_latency(const Benchmark::t_result& result)
+{
+    // NOTE: The work needs to be enqueued from outside the savestate callbacks, as those run while the savestate system is processing its queue.
+    ThreadPool::submit_task([=] {
+        core_st_do_memory({}, core_st_job_save, [=](const core_st_callback_info& save_info, const std::vector<uint8_t>& buf) {
+            auto save_result = result;
+            if (save_info.result != Res_Ok)
+            {
+                finish_benchmark(save_result);
+                return;
+            }
+            save_result.st_save_time = (double)save_info.duration.count() / 1000000.0;
+
+            ThreadPool::submit_task([=] {
+                core_st_do_memory(buf, core_st_job_load, [=](const core_st_callback_info& load_info, const std::vector<uint8_t>&) {
+                    auto load_result = save_result;
+                    if (load_info.result == Res_Ok)
+                    {
+                        load_result.st_load_time = (double)load_info.duration.count() / 1000000.0;
+                    }
+                    finish_benchmark(load_result);
+                },
+                                  true);
+            });
+        },
+                          true);
+    });
 }
 
 static void on_movie_playback_stop()
@@ -128,6 +200,12 @@ static void on_movie_playback_stop()
         return;
     }
 
+    if (ParallelDump::active())
+    {
+        ParallelDump::finish();
+        return;
+    }
+
     if (!cli_params.avi.empty())
     {
         EncodingManager::stop_capture([](auto result) {
@@ -141,11 +219,30 @@ static void on_movie_playback_stop()
     {
         Benchmark::t_result result{};
         Benchmark::stop(&result);
-        Benchmark::save_result_to_file(cli_params.benchmark, result);
-        PostMessage(g_main_hwnd, WM_CLOSE, 0, 0);
+        measure_savestate_latency(result);
     }
 }
 
+static void on_current_sample_changed(std::any data)
+{
+    auto value = std::any_cast<int32_t>(data);
+
+    ParallelDump::on_sample(value);
+
+    if (cli_params.segment_end_vi == -1 || cli_state.segment_ended || core_vcr_get_current_vi() < cli_params.segment_end_vi)
+    {
+        return;
+    }
+
+    // Everything past the segment's end is already being dropped by the encoding manager, so we can stop at our leisure
+    cli_state.segment_ended = true;
+    EncodingManager::stop_capture([](auto result) {
+        if (!result)
+            return;
+        PostMessage(g_main_hwnd, WM_CLOSE, 0, 0);
+    });
+}
+
 static void on_task_changed(std::any data)
 {
     auto value = std::any_cast<core_vcr_task>(data);
@@ -218,6 +315,7 @@ void CLI::init()
     Messenger::subscribe(Messenger::Message::AppReady, on_app_ready);
     Messenger::subscribe(Messenger::Message::TaskChanged, on_task_changed);
     Messenger::subscribe(Messenger::Message::DacrateChanged, on_dacrate_changed);
+    Messenger::subscribe(Messenger::Message::CurrentSampleChanged, on_current_sample_changed);
 
     argh::parser cmdl(__argc, __argv, argh::parser::PREFER_PARAM_FOR_UNREG_OPTION);
 
@@ -229,6 +327,9 @@ void CLI::init()
     cli_params.benchmark = cmdl({"--benchmark", "-b"}, "").str();
     cli_params.close_on_movie_end = cmdl["--close-on-movie-end"];
     cli_params.wait_for_debugger = cmdl["--wait-for-debugger"] || cmdl["--d"];
+    cli_params.parallel_dump = std::stoul(cmdl({"--parallel-dump"}, "0").str());
+    cli_params.segment_st = cmdl({"--segment-st"}, "").str();
+    cli_params.segment_end_vi = std::stoi(cmdl({"--segment-end-vi"}, "-1").str());
     bool compare_control = cmdl["--cmp-ctl"] || cmdl["--compare-control"];
     bool compare_actual = cmdl["--cmp-act"] || cmdl["--compare-actual"];
     std::string compare_interval_str = cmdl({"--cmp-int", "--compare-interval"}, "100").str();
@@ -286,6 +387,14 @@ void CLI::init()
         g_config.core.is_movie_loop_enabled = false;
     }
 
+    // A movie without a ROM starts its own ROM, just like a movie passed as the ROM. It's still played back read-only.
+    if (cli_params.rom.empty() && !cli_params.m64.empty())
+    {
+        cli_params.rom = cli_params.m64;
+        cli_params.m64.clear();
+        g_config.core.vcr_readonly = true;
+    }
+
     // HACK: When playing a movie from start, the rom will start normally and signal us to do our work via EmuLaunchedChanged.
     // The work is started, but then the rom is reset. At that point, the dacrate changes and breaks the capture in some cases.
     // To avoid this, we store the movie's start flag prior to doing anything, and ignore the first EmuLaunchedChanged if it's set.
@@ -316,6 +425,39 @@ void CLI::init()
 
     cli_state.rom_is_movie = cli_params.rom.extension() == ".m64";
 
+    if (cli_params.parallel_dump > 1 && (cli_params.avi.empty() || movie_path.empty()))
+    {
+        DialogService::show_dialog(L"Parallel dump flag specified without a movie and a capture path.\nThe parallel dump won't be performed.", L"CLI", fsvc_error);
+        cli_params.parallel_dump = 0;
+    }
+
+    if (cli_params.parallel_dump > 1 && g_config.encoder_type != (int32_t)t_config::EncoderType::FFmpeg)
+    {
+        DialogService::show_dialog(L"Parallel dumps require the FFmpeg encoder.\nThe movie will be captured normally.", L"CLI", fsvc_warning);
+        cli_params.parallel_dump = 0;
+    }
+
+    if (cli_params.parallel_dump > 1)
+    {
+        // The workers replay the same movie with the same scripts, but only capture their own segment.
+        // The movie is always passed as such, so the workers play it back read-only even if it was passed as the ROM here.
+        std::wstring worker_args = std::format(L"--movie \"{}\"", movie_path.wstring());
+        if (!cli_state.rom_is_movie)
+        {
+            worker_args += std::format(L" --rom \"{}\"", cli_params.rom.wstring());
+        }
+        if (!cli_params.lua.empty())
+        {
+            worker_args += std::format(L" --lua \"{}\"", cli_params.lua.wstring());
+        }
+
+        ParallelDump::start({
+        .path = cli_params.avi,
+        .segments = cli_params.parallel_dump,
+        .worker_args = worker_args,
+        });
+    }
+
     log_cli_params(cli_params);
 }
 
@@ -7,13 +7,233 @@
 #include "stdafx.h"
 #include "Compare.h"
 
+// The granularity at which differences are reported.
+constexpr size_t COMPARE_PAGE_SIZE = 0x1000;
+
+// Magic and version of the hash log file.
+constexpr uint32_t COMPARE_LOG_MAGIC = 0x504D434D; // MCMP
+constexpr uint32_t COMPARE_LOG_VERSION = 1;
+
+/**
+ * An entry in the hash log.
+ */
+struct t_compare_record {
+    // The sample the savestate was created at.
+    uint32_t sample;
+
+    // The hash of the entire savestate.
+    uint64_t hash;
+
+    // The hashes of all pages which changed since the previous record, keyed by page index.
+    std::vector<std::pair<uint32_t, uint64_t>> changed_pages;
+};
+
 static uint8_t compare_mode = 0;
 static size_t compare_interval = 0;
 
+static std::recursive_mutex mtx;
+
+// The page hashes as of the last processed record. In control mode, these are our own, while in actual mode they are the expected ones.
+static std::vector<uint64_t> page_hashes;
+
+// The records read from the log, only used in actual mode.
+static std::vector<t_compare_record> expected_records;
+static size_t expected_record_index = 0;
+
+static bool mismatch_dumped = false;
+
+static std::filesystem::path get_log_path()
+{
+    return get_saves_directory() / L"cmp.xxh";
+}
+
+static std::vector<uint64_t> hash_pages(const std::vector<uint8_t>& buf)
+{
+    std::vector<uint64_t> hashes;
+    hashes.reserve(buf.size() / COMPARE_PAGE_SIZE + 1);
+    for (size_t offset = 0; offset < buf.size(); offset += COMPARE_PAGE_SIZE)
+    {
+        hashes.push_back(xxh64::hash((const char*)buf.data() + offset, std::min(COMPARE_PAGE_SIZE, buf.size() - offset), 0));
+    }
+    return hashes;
+}
+
+static void write_record(const t_compare_record& record)
+{
+    std::vector<uint8_t> buf;
+    auto sample = record.sample;
+    auto hash = record.hash;
+    uint32_t count = record.changed_pages.size();
+    vecwrite(buf, &sample, sizeof(sample));
+    vecwrite(buf, &hash, sizeof(hash));
+    vecwrite(buf, &count, sizeof(count));
+    for (auto [index, page_hash] : record.changed_pages)
+    {
+        vecwrite(buf, &index, sizeof(index));
+        vecwrite(buf, &page_hash, sizeof(page_hash));
+    }
+
+    std::ofstream of(get_log_path(), std::ios::binary | std::ios::app);
+    of.write((const char*)buf.data(), buf.size());
+}
+
+static bool read_log()
+{
+    auto buf = read_file_buffer(get_log_path());
+    if (buf.size() < 8)
+    {
+        return false;
+    }
+
+    auto ptr = buf.data();
+    const auto end = buf.data() + buf.size();
+
+    uint32_t magic;
+    uint32_t version;
+    memread(&ptr, &magic, sizeof(magic));
+    memread(&ptr, &version, sizeof(version));
+    if (magic != COMPARE_LOG_MAGIC || version != COMPARE_LOG_VERSION)
+    {
+        return false;
+    }
+
+    while (end - ptr >= 16)
+    {
+        t_compare_record record{};
+        uint32_t count;
+        memread(&ptr, &record.sample, sizeof(record.sample));
+        memread(&ptr, &record.hash, sizeof(record.hash));
+        memread(&ptr, &count, sizeof(count));
+
+        if ((size_t)(end - ptr) < (size_t)count * 12)
+        {
+            return false;
+        }
+
+        record.changed_pages.resize(count);
+        for (auto& [index, page_hash] : record.changed_pages)
+        {
+            memread(&ptr, &index, sizeof(index));
+            memread(&ptr, &page_hash, sizeof(page_hash));
+        }
+        expected_records.push_back(record);
+    }
+
+    return true;
+}
+
+static void apply_record(const t_compare_record& record)
+{
+    for (const auto [index, page_hash] : record.changed_pages)
+    {
+        if (index >= page_hashes.size())
+        {
+            page_hashes.resize(index + 1);
+        }
+        page_hashes[index] = page_hash;
+    }
+}
+
+static void process_control(size_t sample, const std::vector<uint8_t>& buf)
+{
+    const auto hashes = hash_pages(buf);
+
+    t_compare_record record{
+    .sample = (uint32_t)sample,
+    .hash = xxh64::hash((const char*)buf.data(), buf.size(), 0),
+    };
+    for (uint32_t i = 0; i < hashes.size(); ++i)
+    {
+        if (i >= page_hashes.size() || page_hashes[i] != hashes[i])
+        {
+            record.changed_pages.emplace_back(i, hashes[i]);
+        }
+    }
+
+    page_hashes = hashes;
+    write_record(record);
+}
+
+static void process_actual(size_t sample, const std::vector<uint8_t>& buf)
+{
+    while (expected_record_index < expected_records.size() && expected_records[expected_record_index].sample < sample)
+    {
+        apply_record(expected_records[expected_record_index]);
+        ++expected_record_index;
+    }
+
+    if (expected_record_index >= expected_records.size() || expected_records[expected_record_index].sample != sample)
+    {
+        g_view_logger->warn("No expected hash for frame {}", sample);
+        return;
+    }
+
+    const auto& record = expected_records[expected_record_index];
+    apply_record(record);
+    ++expected_record_index;
+
+    if (xxh64::hash((const char*)buf.data(), buf.size(), 0) == record.hash)
+    {
+        g_view_logger->info("MATCH at frame {}", sample);
+        return;
+    }
+
+    g_view_logger->error("DIFFERENCE at frame {}", sample);
+
+    // Only the first difference is interesting, as everything after it will likely differ too
+    if (mismatch_dumped)
+    {
+        return;
+    }
+    mismatch_dumped = true;
+
+    const auto hashes = hash_pages(buf);
+    std::wstringstream report;
+    report << std::format(L"Savestate at frame {} differs in the following {}-byte pages:\n", sample, COMPARE_PAGE_SIZE);
+    for (size_t i = 0; i < std::max(hashes.size(), page_hashes.size()); ++i)
+    {
+        if (i < hashes.size() && i < page_hashes.size() && hashes[i] == page_hashes[i])
+        {
+            continue;
+        }
+        report << std::format(L"{:#010x}\n", i * COMPARE_PAGE_SIZE);
+        g_view_logger->error("  page at savestate offset {:#010x} differs", i * COMPARE_PAGE_SIZE);
+    }
+
+    std::ofstream st_of(get_saves_directory() / std::format(L"cmp_actual_{}.st", sample), std::ios::binary);
+    st_of.write((const char*)buf.data(), buf.size());
+
+    std::wofstream report_of(get_saves_directory() / std::format(L"cmp_diff_{}.txt", sample));
+    report_of << report.str();
+}
+
 void Compare::start(bool control, size_t interval)
 {
+    std::scoped_lock lock(mtx);
+
     compare_mode = control ? 1 : 2;
     compare_interval = interval;
+    page_hashes.clear();
+    expected_records.clear();
+    expected_record_index = 0;
+    mismatch_dumped = false;
+
+    if (control)
+    {
+        std::vector<uint8_t> header;
+        auto magic = COMPARE_LOG_MAGIC;
+        auto version = COMPARE_LOG_VERSION;
+        vecwrite(header, &magic, sizeof(magic));
+        vecwrite(header, &version, sizeof(version));
+        write_file_buffer(get_log_path(), header);
+        return;
+    }
+
+    if (!read_log())
+    {
+        g_view_logger->error("Failed to read the compare log at {}, comparison will be disabled", get_log_path().string());
+        compare_mode = 0;
+    }
 }
 
 void Compare::compare(size_t current_sample)
@@ -28,31 +248,25 @@ void Compare::compare(size_t current_sample)
         return;
     }
 
-    if (compare_mode == 2)
-    {
-        if (current_sample > compare_interval * 2)
+    core_st_do_memory({}, core_st_job_save, [=](const core_st_callback_info& info, const std::vector<uint8_t>& buf) {
+        if (info.result != Res_Ok)
         {
-            const auto expected_path = get_saves_directory() / std::format(L"cmp_expected_{}.st", current_sample - compare_interval);
-            const auto actual_path = get_saves_directory() / std::format(L"cmp_actual_{}.st", current_sample - compare_interval);
-
-            if (files_are_equal(expected_path, actual_path))
-            {
-                g_view_logger->info("MATCH at frame {}", current_sample - compare_interval);
-            }
-            else
-            {
-                g_view_logger->error("DIFFERENCE at frame {}", current_sample - compare_interval);
-            }
+            g_view_logger->error("Failed to create savestate for comparison at frame {}", current_sample);
+            return;
         }
 
-        const auto actual_path = get_saves_directory() / std::format(L"cmp_actual_{}.st", current_sample);
-        core_st_do_file(actual_path.c_str(), core_st_job_save, nullptr, true);
-
-        return;
-    }
+        std::scoped_lock lock(mtx);
 
-    const auto path = get_saves_directory() / std::format(L"cmp_expected_{}.st", current_sample);
-    core_st_do_file(path.c_str(), core_st_job_save, nullptr, true);
+        if (compare_mode == 1)
+        {
+            process_control(current_sample, buf);
+        }
+        else
+        {
+            process_actual(current_sample, buf);
+        }
+    },
+                      true);
 }
 
 bool Compare::active()
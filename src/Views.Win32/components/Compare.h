@@ -8,20 +8,21 @@
 
 /**
  * A module responsible for comparison of expected and actual savestates during movie playback. Used for regression testing.
+ * The control run records savestate hashes into a compact log in the saves directory, which the actual run then checks against.
  */
 namespace Compare
 {
     /**
      * \brief Starts a comparison.
-     * \param control Whether the comparison is deemed the control (the correct sequence of savestates).
+     * \param control Whether the comparison is deemed the control (the correct sequence of savestates). The control run overwrites the hash log.
      * \param interval The comparison interval.
      */
     void start(bool control, size_t interval);
 
     /**
-     * \brief Performs the comparison between the expected and actual savestates at the current sample.
+     * \brief Records or checks the savestate hash at the current sample. Upon the first mismatch, the actual savestate and a list of the differing pages are dumped to the saves directory.
      * \param current_sample The VCR's current sample.
-     * \warning Requires corresponding savestates to be present in the saves directory. Note that they are not checked for ROM or movie congruence.
+     * \warning Requires a hash log created by a control run to be present in the saves directory. Note that it is not checked for ROM or movie congruence.
      */
     void compare(size_t current_sample);
 
@@ -1090,6 +1090,31 @@ void get_config_listview_items(std::vector<t_options_group>& groups, std::vector
     },
     t_options_item{
     .group_id = seek_piano_roll_group.id,
+    .name = L"Delta Savestates",
+    .tooltip = L"Whether seek savestates are stored as differences to a previous seek savestate.\nGreatly reduces memory usage, allowing for more seek savestates and shorter intervals.",
+    .data = &g_config.core.seek_savestate_delta,
+    .type = t_options_item::Type::Bool,
+    },
+    t_options_item{
+    .group_id = seek_piano_roll_group.id,
+    .name = L"Savestate Compression",
+    .tooltip = L"The codec used to compress seek savestates in the background.\nNone - No compression, highest memory usage\nDeflate - Fast compression with a good ratio (recommended)",
+    .data = &g_config.core.seek_savestate_codec,
+    .type = t_options_item::Type::Enum,
+    .possible_values = {
+    std::make_pair(L"None", (int32_t)core_st_codec_none),
+    std::make_pair(L"Deflate", (int32_t)core_st_codec_deflate),
+    },
+    },
+    t_options_item{
+    .group_id = seek_piano_roll_group.id,
+    .name = L"Savestate Max Size (MB)",
+    .tooltip = L"The maximum total size of seek savestates kept in memory, in megabytes.\nWhen exceeded, savestates are purged such that the remaining ones stay evenly spaced.\n0 - Unlimited",
+    .data = &g_config.core.seek_savestate_max_size,
+    .type = t_options_item::Type::Number,
+    },
+    t_options_item{
+    .group_id = seek_piano_roll_group.id,
     .name = L"Constrain edit to column",
     .tooltip = L"Whether piano roll edits are constrained to the column they started on.",
     .data = &g_config.piano_roll_constrain_edit_to_column,
@@ -1189,11 +1214,21 @@ void get_config_listview_items(std::vector<t_options_group>& groups, std::vector
         return EncodingManager::is_capturing();
     },
     },
+    t_options_item{
+    .group_id = capture_group.id,
+    .name = L"FFmpeg Queue Depth",
+    .tooltip = L"The amount of video frames which can be queued up while FFmpeg is busy. Emulation slows down instead of dropping frames once the queue is full.\nHigher values smooth out encoding hiccups at the cost of memory, which adds up quickly at high resolutions.\nRecommended: 8",
+    .data = &g_config.ffmpeg_queue_depth,
+    .type = t_options_item::Type::Number,
+    .is_readonly = [] {
+        return EncodingManager::is_capturing();
+    },
+    },
 
     t_options_item{
     .group_id = core_group.id,
     .name = L"Type",
-    .tooltip = L"The core type to utilize for emulation.\nInterpreter - Slow and relatively accurate\nDynamic Recompiler - Fast, possibly less accurate, and only for x86 processors\nPure Interpreter - Very slow and accurate",
+    .tooltip = L"The core type to utilize for emulation.\nInterpreter - Slow and relatively accurate\nDynamic Recompiler - Fast, possibly less accurate, and only for x86 processors. 64-bit builds use the Interpreter instead\nPure Interpreter - Very slow and accurate",
     .data = &g_config.core.core_type,
     .type = t_options_item::Type::Enum,
     .possible_values = {
@@ -1292,6 +1327,13 @@ void get_config_listview_items(std::vector<t_options_group>& groups, std::vector
     },
     t_options_item{
     .group_id = vcr_group.id,
+    .name = L"Commit Movie Writes",
+    .tooltip = L"Whether movie writes are committed to the disk before being considered complete.\nProtects the movie file against system crashes and power loss at the cost of slower writes.",
+    .data = &g_config.core.vcr_fsync,
+    .type = t_options_item::Type::Bool,
+    },
+    t_options_item{
+    .group_id = vcr_group.id,
     .name = L"Record Resets",
     .tooltip = L"Record manually performed resets to the current movie.\nThese resets will be repeated when the movie is played back.",
     .data = &g_config.core.is_reset_recording_enabled,
@@ -1329,6 +1371,13 @@ void get_config_listview_items(std::vector<t_options_group>& groups, std::vector
     .data = &g_config.fast_dispatcher,
     .type = t_options_item::Type::Bool,
     },
+    t_options_item{
+    .group_id = lua_group.id,
+    .name = L"Asynchronous Callbacks",
+    .tooltip = L"Delivers event callbacks (atvi, atinterval, atloadstate, atsavestate, atreset, etc.) without waiting for the scripts to process them, so scripts which only observe emulation don't slow it down.\nThe emulation state may have advanced by the time such a callback runs, and memory writes, savestate operations or pauses made from it take effect at an unpredictable point, which can desync movies. Only enable when all running scripts merely observe emulation.",
+    .data = &g_config.async_lua_callbacks,
+    .type = t_options_item::Type::Bool,
+    },
 
     t_options_item{
     .group_id = debug_group.id,
@@ -1346,11 +1395,25 @@ void get_config_listview_items(std::vector<t_options_group>& groups, std::vector
     },
     t_options_item{
     .group_id = debug_group.id,
+    .name = L"Audio Update Timeout",
+    .tooltip = L"The maximum time in milliseconds the audio thread waits for an AI event before updating the audio plugin anyway.\nAlso used as the audio update batching interval during fast-forward.",
+    .data = &g_config.core.audio_update_timeout,
+    .type = t_options_item::Type::Number,
+    },
+    t_options_item{
+    .group_id = debug_group.id,
     .name = L"Compiled Jump",
     .tooltip = L"Whether the Dynamic Recompiler core compiles jumps.",
     .data = &g_config.core.is_compiled_jump_enabled,
     .type = t_options_item::Type::Bool,
     },
+    t_options_item{
+    .group_id = debug_group.id,
+    .name = L"Code Cache Size",
+    .tooltip = L"The size of the Dynamic Recompiler core's code cache in megabytes.\nWhen half of it is filled, all compiled code is discarded and recompiled on demand.\nChanges take effect when the core is restarted.",
+    .data = &g_config.core.code_cache_size,
+    .type = t_options_item::Type::Number,
+    },
     };
 
     for (const auto hotkey : g_config_hotkeys)
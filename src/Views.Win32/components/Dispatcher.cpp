@@ -22,14 +22,45 @@ void Dispatcher::invoke(const std::function<void()>& func)
         return;
     }
 
-    std::lock_guard lock(m_mutex);
-    m_queue.push(func);
+    std::lock_guard invoke_lock(m_invoke_mutex);
+    {
+        std::lock_guard lock(m_mutex);
+        m_queue.push(func);
+    }
     m_execute_callback();
 }
 
+void Dispatcher::invoke_async(const std::function<void()>& func)
+{
+    if (GetCurrentThreadId() == m_thread_id || !m_post_callback)
+    {
+        invoke(func);
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_queue.push(func);
+    }
+
+    // OPTIMIZATION: Only wake the dispatcher's thread up once per batch, it'll pick up everything queued in the meantime
+    if (!m_post_pending.exchange(true))
+    {
+        m_post_callback();
+    }
+}
+
 void Dispatcher::execute()
 {
-    if (m_queue.empty())
+    m_post_pending = false;
+
+    std::queue<std::function<void()>> queue;
+    {
+        std::lock_guard lock(m_mutex);
+        std::swap(queue, m_queue);
+    }
+
+    if (queue.empty())
     {
         return;
     }
@@ -38,10 +69,10 @@ void Dispatcher::execute()
     const auto execute_start = std::chrono::high_resolution_clock::now();
 #endif
 
-    while (!m_queue.empty())
+    while (!queue.empty())
     {
-        m_queue.front()();
-        m_queue.pop();
+        queue.front()();
+        queue.pop();
     }
 
 #ifdef DISPATCHER_OVERHEAD_LOGGING
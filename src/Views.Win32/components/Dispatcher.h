@@ -14,10 +14,11 @@ public:
     /**
      * Creates a new dispatcher.
      * \param thread_id The dispatcher's target thread id.
-     * \param execute_callback The callback that will be called when the queue has to be executed on the target thread.
+     * \param execute_callback The callback that will be called when the queue has to be executed on the target thread. Must not return until the queue has been executed.
+     * \param post_callback The callback that will be called when the queue has to be executed on the target thread at some later point. Must not wait for the queue to be executed. Can be null.
      */
-    explicit Dispatcher(const DWORD thread_id, const std::function<void()>& execute_callback) :
-        m_execute_callback(execute_callback), m_thread_id(thread_id)
+    explicit Dispatcher(const DWORD thread_id, const std::function<void()>& execute_callback, const std::function<void()>& post_callback = nullptr) :
+        m_execute_callback(execute_callback), m_post_callback(post_callback), m_thread_id(thread_id)
     {
     }
 
@@ -27,6 +28,14 @@ public:
      */
     void invoke(const std::function<void()>& func);
 
+    /**
+     * \brief Queues a function for execution on the dispatcher's thread without waiting for it to be executed.
+     * \param func The function to be executed
+     * \remarks Functions queued while the dispatcher's thread hasn't caught up yet are executed in one batch. Ordering relative to <c>invoke</c> is preserved.
+     * If the dispatcher has no post callback, this function behaves like <c>invoke</c>.
+     */
+    void invoke_async(const std::function<void()>& func);
+
     /**
      * \brief Executes the pending functions on the current thread.
      */
@@ -34,10 +43,19 @@ public:
 
 private:
     std::function<void()> m_execute_callback{};
+    std::function<void()> m_post_callback{};
     DWORD m_thread_id{};
     std::queue<std::function<void()>> m_queue{};
+
+    // Protects the queue
     std::mutex m_mutex{};
 
+    // Held during synchronous invocations, as the execute callback can't tell apart multiple concurrent callers
+    std::mutex m_invoke_mutex{};
+
+    // Whether a post callback was issued which the dispatcher's thread hasn't acted upon yet
+    std::atomic<bool> m_post_pending{};
+
     uint64_t m_overhead_times[60]{};
     double m_overhead_percentages[60]{};
     size_t m_overhead_index{};
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "stdafx.h"
+#include <Config.h>
+#include <DialogService.h>
+#include <ThreadPool.h>
+#include <components/ParallelDump.h>
+
+/**
+ * A segment of the movie, captured by one worker process.
+ */
+struct t_segment {
+    // The savestate the segment starts at. Empty for the first segment, which starts with the movie.
+    std::filesystem::path st;
+
+    // The movie VI the segment starts at.
+    int32_t start_vi;
+};
+
+// The minimum time the workers get to capture their segments.
+constexpr auto MIN_WORKER_TIMEOUT = std::chrono::minutes(10);
+
+// How many times longer than the first playthrough the workers get to capture their segments.
+constexpr size_t WORKER_TIMEOUT_FACTOR = 10;
+
+static std::mutex mtx;
+
+static std::atomic<bool> dump_active = false;
+static ParallelDump::t_params dump_params{};
+
+// The segments whose starting point is known, ordered by their starting VI.
+static std::vector<t_segment> segments;
+
+// The index of the next segment boundary to save a savestate at.
+static size_t next_boundary = 1;
+
+// When the first playthrough started.
+static std::chrono::steady_clock::time_point playthrough_start;
+
+// The movie VI the first playthrough ended at, which is where the last segment ends.
+static int32_t end_vi = -1;
+
+static std::filesystem::path get_work_directory()
+{
+    auto path = dump_params.path;
+    path.replace_extension(L".segments");
+    return path;
+}
+
+static std::filesystem::path get_segment_path(size_t index)
+{
+    return get_work_directory() / std::format(L"segment_{}.mp4", index);
+}
+
+/**
+ * \brief Starts a process and returns its handle, or nullptr if the process couldn't be started.
+ */
+static HANDLE start_process(const std::wstring& app, const std::wstring& args)
+{
+    auto cmdline = std::format(L"\"{}\" {}", app, args);
+
+    STARTUPINFO si{.cb = sizeof(STARTUPINFO)};
+    PROCESS_INFORMATION pi{};
+
+    g_view_logger->info(L"[ParallelDump] Starting {}", cmdline);
+
+    if (!CreateProcess(app.c_str(), cmdline.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &si, &pi))
+    {
+        g_view_logger->error(L"[ParallelDump] CreateProcess failed ({})", GetLastError());
+        return nullptr;
+    }
+
+    CloseHandle(pi.hThread);
+    return pi.hProcess;
+}
+
+/**
+ * \brief Waits for a process to exit and closes its handle.
+ * \param process The process.
+ * \param timeout The time to wait for in milliseconds. The process is terminated if it's still running afterwards.
+ * \return The process' exit code.
+ */
+static DWORD wait_for_process(HANDLE process, DWORD timeout = INFINITE)
+{
+    DWORD exit_code = 1;
+    if (WaitForSingleObject(process, timeout) == WAIT_TIMEOUT)
+    {
+        g_view_logger->error("[ParallelDump] Process didn't exit in time, terminating it");
+        TerminateProcess(process, WAIT_TIMEOUT);
+        WaitForSingleObject(process, INFINITE);
+    }
+    GetExitCodeProcess(process, &exit_code);
+    CloseHandle(process);
+    return exit_code;
+}
+
+/**
+ * \brief Captures all segments in parallel and concatenates them into the final capture.
+ * \return The error message if the operation failed, or an empty optional if it succeeded.
+ */
+static std::optional<std::wstring> capture_segments()
+{
+    wchar_t app_path[MAX_PATH]{};
+    GetModuleFileName(nullptr, app_path, std::size(app_path));
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    // A worker which never reaches its segment's end mustn't keep the dump waiting forever
+    const auto worker_timeout = std::max(std::chrono::duration_cast<std::chrono::milliseconds>((start_time - playthrough_start) * WORKER_TIMEOUT_FACTOR), std::chrono::duration_cast<std::chrono::milliseconds>(MIN_WORKER_TIMEOUT));
+    const auto deadline = start_time + worker_timeout;
+
+    std::vector<HANDLE> workers;
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        auto args = std::format(L"{} --avi \"{}\"", dump_params.worker_args, get_segment_path(i).wstring());
+
+        if (!segments[i].st.empty())
+        {
+            args += std::format(L" --segment-st \"{}\"", segments[i].st.wstring());
+        }
+
+        const auto segment_end_vi = i + 1 < segments.size() ? segments[i + 1].start_vi : end_vi;
+        if (segment_end_vi != -1)
+        {
+            args += std::format(L" --segment-end-vi {}", segment_end_vi);
+        }
+
+        const auto worker = start_process(app_path, args);
+        if (!worker)
+        {
+            for (const auto started_worker : workers)
+            {
+                TerminateProcess(started_worker, 1);
+                CloseHandle(started_worker);
+            }
+            return std::format(L"Failed to start the worker process for segment {}.", i);
+        }
+        workers.push_back(worker);
+    }
+
+    std::vector<size_t> failed_segments;
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (const auto exit_code = wait_for_process(workers[i], (DWORD)std::max(remaining.count(), (int64_t)0)))
+        {
+            g_view_logger->error("[ParallelDump] Worker for segment {} exited with code {}", i, exit_code);
+            failed_segments.push_back(i);
+        }
+    }
+
+    if (!failed_segments.empty())
+    {
+        std::wstring indices;
+        for (const auto index : failed_segments)
+        {
+            indices += std::format(L"{}{}", indices.empty() ? L"" : L", ", index);
+        }
+        return std::format(L"The worker processes for segments {} failed. Check their logs for details.\nThe segments were kept at '{}'.", indices, get_work_directory().wstring());
+    }
+
+    g_view_logger->info("[ParallelDump] Captured {} segments in {}s", segments.size(), std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_time).count());
+
+    // The list is read by FFmpeg's concat demuxer, which resolves relative paths against the list's location
+    const auto list_path = get_work_directory() / L"segments.txt";
+    {
+        std::wofstream list(list_path);
+        for (size_t i = 0; i < segments.size(); ++i)
+        {
+            std::error_code ec;
+            if (std::filesystem::file_size(get_segment_path(i), ec) == 0 || ec)
+            {
+                return std::format(L"Segment {} wasn't captured. Check the worker's log for details.", i);
+            }
+            list << std::format(L"file '{}'\n", get_segment_path(i).filename().wstring());
+        }
+    }
+
+    DeleteFile(dump_params.path.wstring().c_str());
+
+    const auto ffmpeg = start_process(g_config.ffmpeg_path, std::format(L"-y -f concat -safe 0 -i \"{}\" -c copy \"{}\"", list_path.wstring(), dump_params.path.wstring()));
+    if (!ffmpeg)
+    {
+        return std::format(L"Failed to start ffmpeg process! Does ffmpeg exist on disk at '{}'?", g_config.ffmpeg_path);
+    }
+
+    if (const auto exit_code = wait_for_process(ffmpeg))
+    {
+        return std::format(L"FFmpeg failed to concatenate the segments (exit code {}).\nThe segments were kept at '{}'.", exit_code, get_work_directory().wstring());
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(get_work_directory(), ec);
+
+    return std::nullopt;
+}
+
+void ParallelDump::start(const t_params& params)
+{
+    std::scoped_lock lock(mtx);
+
+    dump_params = params;
+    segments = {t_segment{.st = {}, .start_vi = 0}};
+    next_boundary = 1;
+    playthrough_start = std::chrono::steady_clock::now();
+    end_vi = -1;
+
+    std::error_code ec;
+    std::filesystem::create_directories(get_work_directory(), ec);
+    if (ec)
+    {
+        g_view_logger->error(L"[ParallelDump] Failed to create the work directory at {}", get_work_directory().wstring());
+    }
+
+    dump_active = true;
+
+    g_view_logger->info(L"[ParallelDump] Dumping to {} in {} segments", dump_params.path.wstring(), dump_params.segments);
+}
+
+bool ParallelDump::active()
+{
+    return dump_active;
+}
+
+void ParallelDump::on_sample(size_t current_sample)
+{
+    size_t index;
+    {
+        std::scoped_lock lock(mtx);
+
+        if (!dump_active || next_boundary >= dump_params.segments)
+        {
+            return;
+        }
+
+        const size_t length = core_vcr_get_length_samples();
+        if (length == UINT32_MAX || current_sample < length * next_boundary / dump_params.segments)
+        {
+            return;
+        }
+
+        index = next_boundary++;
+    }
+
+    core_st_do_memory({}, core_st_job_save, [=](const core_st_callback_info& info, const std::vector<uint8_t>& buf) {
+        if (info.result != Res_Ok)
+        {
+            g_view_logger->error("[ParallelDump] Failed to create savestate for segment {}, it will be merged into the previous one", index);
+            return;
+        }
+
+        const auto path = get_work_directory() / std::format(L"segment_{}.st", index);
+
+        std::ofstream of(path, std::ios::binary);
+        of.write((const char*)buf.data(), buf.size());
+        if (!of.good())
+        {
+            g_view_logger->error(L"[ParallelDump] Failed to write savestate to {}, it will be merged into the previous one", path.wstring());
+            return;
+        }
+
+        // The savestate system does its work between VIs, so the current VI is exactly where the segment starts
+        std::scoped_lock lock(mtx);
+        segments.push_back(t_segment{.st = path, .start_vi = core_vcr_get_current_vi()});
+        g_view_logger->info("[ParallelDump] Segment {} starts at VI {}", index, segments.back().start_vi);
+    },
+                       true);
+}
+
+void ParallelDump::finish()
+{
+    // Emulation isn't needed anymore, so the workers get all the cores
+    core_vr_pause_emu();
+
+    {
+        std::scoped_lock lock(mtx);
+        end_vi = core_vcr_get_current_vi();
+    }
+
+    ThreadPool::submit_task([] {
+        std::optional<std::wstring> result;
+        {
+            std::scoped_lock lock(mtx);
+            dump_active = false;
+            result = capture_segments();
+        }
+
+        if (result.has_value())
+        {
+            DialogService::show_dialog(result.value().c_str(), L"Parallel Dump", fsvc_error);
+        }
+        else
+        {
+            g_view_logger->info(L"[ParallelDump] Finished dumping to {}", dump_params.path.wstring());
+        }
+
+        PostMessage(g_main_hwnd, WM_CLOSE, 0, 0);
+    });
+}
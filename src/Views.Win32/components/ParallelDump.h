@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2025, Mupen64 maintainers, contributors, and original authors (Hacktarux, ShadowPrince, linker).
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+/**
+ * A module responsible for capturing a movie in parallel.
+ * A first playthrough saves savestates at segment boundaries, after which every segment is captured by its own emulator process and the segments are concatenated with FFmpeg.
+ */
+namespace ParallelDump
+{
+    struct t_params {
+        /// The final capture's path.
+        std::filesystem::path path;
+
+        /// The amount of segments, each of which is captured by its own process.
+        size_t segments;
+
+        /// The command-line arguments passed on to every worker process, excluding the capture and segment ones.
+        std::wstring worker_args;
+    };
+
+    /**
+     * \brief Starts the first playthrough of a parallel dump.
+     * \param params The parameters to dump with.
+     * \remarks Movie playback must be started separately.
+     */
+    void start(const t_params& params);
+
+    /**
+     * \brief Gets whether this process is doing the first playthrough of a parallel dump.
+     */
+    bool active();
+
+    /**
+     * \brief Saves a savestate if the sample is a segment boundary.
+     * \param current_sample The VCR's current sample.
+     */
+    void on_sample(size_t current_sample);
+
+    /**
+     * \brief Ends the first playthrough, captures all segments in parallel and concatenates them. The application is closed afterwards.
+     * \remarks The work is done asynchronously.
+     */
+    void finish();
+} // namespace ParallelDump
@@ -25,6 +25,16 @@ struct t_atwindowmessage_context {
 
 static t_atwindowmessage_context atwindowmessage_ctx{};
 static int current_input_n = 0;
+static int32_t current_warp_modify_status = 0;
+
+// The amount of callbacks queued with invoke_observer which haven't run yet
+static std::atomic<size_t> pending_observer_calls = 0;
+
+// Whether an atinterval invocation is queued and hasn't run yet
+static std::atomic<bool> interval_pending = false;
+
+// The amount of queued callbacks after which invoke_observer waits for the GUI thread to catch up
+constexpr size_t MAX_PENDING_OBSERVER_CALLS = 64;
 
 const std::unordered_map<LuaCallbacks::callback_key, std::function<int(lua_State*)>> CALLBACK_FUNC_MAP = {
 {LuaCallbacks::REG_ATINPUT, [](auto l) -> int {
@@ -39,7 +49,7 @@ const std::unordered_map<LuaCallbacks::callback_key, std::function<int(lua_State
      return lua_pcall(l, 4, 0, 0);
  }},
 {LuaCallbacks::REG_ATWARPMODIFYSTATUSCHANGED, [](auto l) -> int {
-     lua_pushinteger(l, core_vcr_get_warp_modify_status());
+     lua_pushinteger(l, current_warp_modify_status);
      return lua_pcall(l, 1, 0, 0);
  }},
 };
@@ -53,6 +63,26 @@ static std::function<int(lua_State*)> get_function_for_callback(const LuaCallbac
     return pcall_no_params;
 }
 
+/**
+ * \brief Invokes a function whose result isn't needed by the emulation thread on the GUI thread.
+ * \remarks If asynchronous Lua callbacks are enabled, this doesn't wait for the function to run unless the GUI thread is too far behind, in which case it waits for the backlog to drain.
+ * Scripts can still write memory, load savestates or pause from these callbacks, which then race the emulation thread, so asynchronous delivery is opt-in.
+ */
+static void invoke_observer(const std::function<void()>& func)
+{
+    if (!g_config.async_lua_callbacks || pending_observer_calls >= MAX_PENDING_OBSERVER_CALLS)
+    {
+        g_main_window_dispatcher->invoke(func);
+        return;
+    }
+
+    ++pending_observer_calls;
+    g_main_window_dispatcher->invoke_async([=] {
+        --pending_observer_calls;
+        func();
+    });
+}
+
 core_buttons LuaCallbacks::get_last_controller_data(int index)
 {
     return last_controller_data[index];
@@ -76,7 +106,7 @@ void LuaCallbacks::call_window_message(void* wnd, unsigned int msg, unsigned int
 void LuaCallbacks::call_vi()
 {
     RET_IF_EMPTY;
-    g_main_window_dispatcher->invoke([] {
+    invoke_observer([] {
         invoke_callbacks_with_key_on_all_instances(REG_ATVI);
     });
 }
@@ -106,7 +136,15 @@ void LuaCallbacks::call_input(core_buttons* input, int index)
 void LuaCallbacks::call_interval()
 {
     RET_IF_EMPTY;
-    g_main_window_dispatcher->invoke([] {
+
+    // OPTIMIZATION: atinterval is a heartbeat, so there's no point in queuing it up while a previous one hasn't run yet
+    if (g_config.async_lua_callbacks && interval_pending.exchange(true))
+    {
+        return;
+    }
+
+    invoke_observer([] {
+        interval_pending = false;
         invoke_callbacks_with_key_on_all_instances(REG_ATINTERVAL);
     });
 }
@@ -114,7 +152,7 @@ void LuaCallbacks::call_interval()
 void LuaCallbacks::call_play_movie()
 {
     RET_IF_EMPTY;
-    g_main_window_dispatcher->invoke([] {
+    invoke_observer([] {
         invoke_callbacks_with_key_on_all_instances(REG_ATPLAYMOVIE);
     });
 }
@@ -122,7 +160,7 @@ void LuaCallbacks::call_play_movie()
 void LuaCallbacks::call_stop_movie()
 {
     RET_IF_EMPTY;
-    g_main_window_dispatcher->invoke([] {
+    invoke_observer([] {
         invoke_callbacks_with_key_on_all_instances(REG_ATSTOPMOVIE);
     });
 }
@@ -130,7 +168,7 @@ void LuaCallbacks::call_stop_movie()
 void LuaCallbacks::call_load_state()
 {
     RET_IF_EMPTY;
-    g_main_window_dispatcher->invoke([] {
+    invoke_observer([] {
         invoke_callbacks_with_key_on_all_instances(REG_ATLOADSTATE);
     });
 }
@@ -138,7 +176,7 @@ void LuaCallbacks::call_load_state()
 void LuaCallbacks::call_save_state()
 {
     RET_IF_EMPTY;
-    g_main_window_dispatcher->invoke([] {
+    invoke_observer([] {
         invoke_callbacks_with_key_on_all_instances(REG_ATSAVESTATE);
     });
 }
@@ -146,7 +184,7 @@ void LuaCallbacks::call_save_state()
 void LuaCallbacks::call_reset()
 {
     RET_IF_EMPTY;
-    g_main_window_dispatcher->invoke([] {
+    invoke_observer([] {
         invoke_callbacks_with_key_on_all_instances(REG_ATRESET);
     });
 }
@@ -154,7 +192,7 @@ void LuaCallbacks::call_reset()
 void LuaCallbacks::call_seek_completed()
 {
     RET_IF_EMPTY;
-    g_main_window_dispatcher->invoke([] {
+    invoke_observer([] {
         invoke_callbacks_with_key_on_all_instances(REG_ATSEEKCOMPLETED);
     });
 }
@@ -162,11 +200,52 @@ void LuaCallbacks::call_seek_completed()
 void LuaCallbacks::call_warp_modify_status_changed(const int32_t status)
 {
     RET_IF_EMPTY;
-    g_main_window_dispatcher->invoke([=] {
+    invoke_observer([=] {
+        current_warp_modify_status = status;
         invoke_callbacks_with_key_on_all_instances(REG_ATWARPMODIFYSTATUSCHANGED);
     });
 }
 
+void LuaCallbacks::call_watch_hit(const core_dbg_watch_hit* hit)
+{
+    RET_IF_EMPTY;
+
+    invoke_observer([hit = *hit] {
+        t_lua_environment* failed = nullptr;
+
+        for (const auto& lua : g_lua_environments)
+        {
+            if (!lua->watches.contains(hit.id))
+            {
+                continue;
+            }
+
+            lua_rawgeti(lua->L, LUA_REGISTRYINDEX, lua->watches.at(hit.id));
+            lua_pushinteger(lua->L, hit.address);
+            lua_pushinteger(lua->L, hit.size);
+            lua_pushstring(lua->L, hit.kind == core_dbg_watch_read ? "r" : hit.kind == core_dbg_watch_write ? "w" : "x");
+            lua_pushinteger(lua->L, (lua_Integer)hit.value);
+            lua_pushinteger(lua->L, hit.pc);
+
+            if (lua_pcall(lua->L, 5, 0, 0))
+            {
+                const char* str = lua_tostring(lua->L, -1);
+                print_con(lua->hwnd, string_to_wstring(str) + L"\r\n");
+                g_view_logger->info("Lua error: {}", str);
+                failed = lua;
+            }
+
+            // Watch identifiers are unique, so only one instance can own the watch
+            break;
+        }
+
+        if (failed)
+        {
+            destroy_lua_environment(failed);
+        }
+    });
+}
+
 bool invoke_callbacks_with_key_impl(const t_lua_environment& lua, const std::function<int(lua_State*)>& function, LuaCallbacks::callback_key key)
 {
     assert(is_on_gui_thread());
@@ -94,6 +94,12 @@ namespace LuaCallbacks
      */
     void call_warp_modify_status_changed(int32_t status);
 
+    /**
+     * \brief Notifies the lua instance which added a memory watch of the watch being hit
+     * \param hit The access which hit the watch
+     */
+    void call_watch_hit(const core_dbg_watch_hit* hit);
+
     /**
      * \brief Invokes the registered callbacks with the specified key on the specified Lua environment.
      * \param lua The Lua environment.
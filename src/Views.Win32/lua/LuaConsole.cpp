@@ -266,6 +266,11 @@ void destroy_lua_environment(t_lua_environment* lua)
     std::erase_if(g_lua_environments, [=](const t_lua_environment* v) {
         return v == lua;
     });
+    for (const auto& [id, _] : lua->watches)
+    {
+        core_dbg_remove_watch(id);
+    }
+    lua->watches.clear();
     SetProp(lua->hwnd, LUA_PROP_NAME, nullptr);
     rebuild_lua_env_map();
 
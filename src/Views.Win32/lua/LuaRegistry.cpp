@@ -104,6 +104,16 @@ const luaL_Reg MEMORY_FUNCS[] = {
 
 {"writesize", LuaCore::Memory::LuaWriteSize},
 
+// bulk functions
+{"readblock", LuaCore::Memory::LuaReadBlock},
+{"writeblock", LuaCore::Memory::LuaWriteBlock},
+{"readstruct", LuaCore::Memory::LuaReadStruct},
+{"gather", LuaCore::Memory::LuaGather},
+
+// watch functions
+{"addwatch", LuaCore::Memory::LuaAddWatch},
+{"removewatch", LuaCore::Memory::LuaRemoveWatch},
+
 {"recompilenow", LuaCore::Memory::Recompile},
 {"recompile", LuaCore::Memory::Recompile},
 {"recompilenext", LuaCore::Memory::Recompile},
@@ -66,4 +66,6 @@ struct t_lua_environment {
     HWND hwnd;
     lua_State* L;
     t_lua_rendering_context rctx;
+    // The memory watches added by the script, mapping the core's watch identifiers to the registry references of their callbacks.
+    std::map<uint32_t, int> watches;
 };
@@ -223,6 +223,266 @@ namespace LuaCore::Memory
         return 0;
     }
 
+    // Bulk functions
+
+    // The largest block which can be read or written at once, which is the size of the expanded RDRAM
+    constexpr size_t MAX_BLOCK_SIZE = CORE_ADDR_MASK + 1;
+
+    // A value type accepted by the bulk functions: a size as in readsize, or a floating-point type
+    enum class ValueType {
+        U8,
+        U16,
+        U32,
+        U64,
+        S8,
+        S16,
+        S32,
+        S64,
+        Float,
+        Double,
+    };
+
+    static ValueType LuaCheckValueType(lua_State* L, int i)
+    {
+        if (lua_type(L, i) == LUA_TSTRING)
+        {
+            const std::string_view name = lua_tostring(L, i);
+            if (name == "float")
+            {
+                return ValueType::Float;
+            }
+            if (name == "double")
+            {
+                return ValueType::Double;
+            }
+            luaL_error(L, "type must be 1, 2, 4, 8, -1, -2, -4, -8, \"float\" or \"double\"");
+        }
+
+        switch (luaL_checkinteger(L, i))
+        {
+        case 1:
+            return ValueType::U8;
+        case 2:
+            return ValueType::U16;
+        case 4:
+            return ValueType::U32;
+        case 8:
+            return ValueType::U64;
+        case -1:
+            return ValueType::S8;
+        case -2:
+            return ValueType::S16;
+        case -4:
+            return ValueType::S32;
+        case -8:
+            return ValueType::S64;
+        default:
+            luaL_error(L, "type must be 1, 2, 4, 8, -1, -2, -4, -8, \"float\" or \"double\"");
+        }
+        return ValueType::U8;
+    }
+
+    static uint64_t LoadQword(uint32_t addr)
+    {
+        return (uint64_t)core_rdram_load<uint32_t>((uint8_t*)g_core.rdram, addr) << 32 | core_rdram_load<uint32_t>((uint8_t*)g_core.rdram, addr + 4);
+    }
+
+    /**
+     * \brief Pushes the value of the specified type at an address. 64-bit values are pushed as integers instead of qword tables.
+     */
+    static void LuaPushValue(lua_State* L, uint32_t addr, ValueType type)
+    {
+        const auto rdram = (uint8_t*)g_core.rdram;
+
+        switch (type)
+        {
+        case ValueType::U8:
+            lua_pushinteger(L, core_rdram_load<uint8_t>(rdram, addr));
+            break;
+        case ValueType::U16:
+            lua_pushinteger(L, core_rdram_load<uint16_t>(rdram, addr));
+            break;
+        case ValueType::U32:
+            lua_pushinteger(L, core_rdram_load<uint32_t>(rdram, addr));
+            break;
+        case ValueType::U64:
+        case ValueType::S64:
+            lua_pushinteger(L, (lua_Integer)LoadQword(addr));
+            break;
+        case ValueType::S8:
+            lua_pushinteger(L, core_rdram_load<int8_t>(rdram, addr));
+            break;
+        case ValueType::S16:
+            lua_pushinteger(L, core_rdram_load<int16_t>(rdram, addr));
+            break;
+        case ValueType::S32:
+            lua_pushinteger(L, core_rdram_load<int32_t>(rdram, addr));
+            break;
+        case ValueType::Float:
+            {
+                const uint32_t value = core_rdram_load<uint32_t>(rdram, addr);
+                lua_pushnumber(L, *(float*)&value);
+                break;
+            }
+        case ValueType::Double:
+            {
+                const uint64_t value = LoadQword(addr);
+                lua_pushnumber(L, *(double*)&value);
+                break;
+            }
+        }
+    }
+
+    static int LuaReadBlock(lua_State* L)
+    {
+        const auto addr = (uint32_t)luaL_checkinteger(L, 1);
+        const auto len = luaL_checkinteger(L, 2);
+        luaL_argcheck(L, len >= 0 && (size_t)len <= MAX_BLOCK_SIZE, 2, "length out of range");
+
+        const auto rdram = (uint8_t*)g_core.rdram;
+
+        luaL_Buffer b;
+        char* data = luaL_buffinitsize(L, &b, len);
+
+        // RDRAM is stored as native-endian words, so each byte has to be fetched from its swapped position
+        for (lua_Integer i = 0; i < len; ++i)
+        {
+            data[i] = (char)rdram[((addr + (uint32_t)i) ^ 3) & CORE_ADDR_MASK];
+        }
+
+        luaL_pushresultsize(&b, len);
+        return 1;
+    }
+
+    static int LuaWriteBlock(lua_State* L)
+    {
+        const auto addr = (uint32_t)luaL_checkinteger(L, 1);
+        size_t len;
+        const char* data = luaL_checklstring(L, 2, &len);
+        luaL_argcheck(L, len <= MAX_BLOCK_SIZE, 2, "data too long");
+
+        const auto rdram = (uint8_t*)g_core.rdram;
+
+        for (size_t i = 0; i < len; ++i)
+        {
+            rdram[((addr + (uint32_t)i) ^ 3) & CORE_ADDR_MASK] = (uint8_t)data[i];
+        }
+
+        return 0;
+    }
+
+    static int LuaReadStruct(lua_State* L)
+    {
+        const auto addr = (uint32_t)luaL_checkinteger(L, 1);
+        luaL_checktype(L, 2, LUA_TTABLE);
+
+        lua_newtable(L);
+        const int result = lua_gettop(L);
+
+        // Each layout entry maps a field name to an {offset, type} pair
+        lua_pushnil(L);
+        while (lua_next(L, 2))
+        {
+            luaL_argcheck(L, lua_istable(L, -1), 2, "layout entries must be {offset, type} tables");
+
+            lua_rawgeti(L, -1, 1);
+            const auto offset = (uint32_t)luaL_checkinteger(L, -1);
+            lua_rawgeti(L, -2, 2);
+            const auto type = LuaCheckValueType(L, -1);
+            lua_pop(L, 3);
+
+            // Copy the key so lua_next still has it after the assignment
+            lua_pushvalue(L, -1);
+            LuaPushValue(L, addr + offset, type);
+            lua_rawset(L, result);
+        }
+
+        return 1;
+    }
+
+    static int LuaGather(lua_State* L)
+    {
+        luaL_checktype(L, 1, LUA_TTABLE);
+        const auto type = LuaCheckValueType(L, 2);
+        const auto count = luaL_len(L, 1);
+
+        lua_createtable(L, (int)count, 0);
+
+        for (lua_Integer i = 1; i <= count; ++i)
+        {
+            lua_rawgeti(L, 1, i);
+            const auto addr = (uint32_t)luaL_checkinteger(L, -1);
+            lua_pop(L, 1);
+
+            LuaPushValue(L, addr, type);
+            lua_rawseti(L, -2, i);
+        }
+
+        return 1;
+    }
+
+    static int LuaAddWatch(lua_State* L)
+    {
+        auto lua = get_lua_class(L);
+
+        const auto addr = (uint32_t)luaL_checkinteger(L, 1);
+        const auto size = (uint32_t)luaL_checkinteger(L, 2);
+        const std::string_view kinds_str = luaL_checkstring(L, 3);
+        luaL_checktype(L, 4, LUA_TFUNCTION);
+
+        uint32_t kinds = 0;
+        for (const char c : kinds_str)
+        {
+            switch (c)
+            {
+            case 'r':
+                kinds |= core_dbg_watch_read;
+                break;
+            case 'w':
+                kinds |= core_dbg_watch_write;
+                break;
+            case 'x':
+                kinds |= core_dbg_watch_exec;
+                break;
+            default:
+                luaL_error(L, "kinds must only contain 'r', 'w' and 'x'");
+            }
+        }
+
+        uint32_t id;
+        const auto result = core_dbg_add_watch(addr, size, kinds, &id);
+        if (result == DBG_ExecWatchUnsupported)
+        {
+            luaL_error(L, "execution watches are only supported by the pure interpreter");
+        }
+        if (result != Res_Ok)
+        {
+            luaL_error(L, "invalid watch range or kinds");
+        }
+
+        lua_pushvalue(L, 4);
+        lua->watches[id] = luaL_ref(L, LUA_REGISTRYINDEX);
+
+        lua_pushinteger(L, id);
+        return 1;
+    }
+
+    static int LuaRemoveWatch(lua_State* L)
+    {
+        auto lua = get_lua_class(L);
+
+        const auto id = (uint32_t)luaL_checkinteger(L, 1);
+        if (!lua->watches.contains(id))
+        {
+            luaL_error(L, "no watch with this identifier was added by this script");
+        }
+
+        core_dbg_remove_watch(id);
+        luaL_unref(L, LUA_REGISTRYINDEX, lua->watches.at(id));
+        lua->watches.erase(id);
+        return 0;
+    }
+
     static int LuaIntToFloat(lua_State* L)
     {
         ULONG n = luaL_checknumber(L, 1);
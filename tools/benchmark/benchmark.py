@@ -26,6 +26,17 @@ FPS_PERCENTAGE_EPSILON = 1
 WARMUP_RUN_COUNT = 3
 NORMAL_RUN_COUNT = 6
 
+# The core types to benchmark, keyed by their config value.
+CORE_TYPES = { 0: "cached-interp", 1: "dynarec", 2: "pure-interp" }
+
+# Metrics reported alongside FPS. Higher is better unless listed in LOWER_IS_BETTER_METRICS.
+REPORTED_METRICS = [ 'vis_per_second', 'frame_time_p50', 'frame_time_p95', 'frame_time_p99', 'peak_rss', 'st_save_time', 'st_load_time' ]
+LOWER_IS_BETTER_METRICS = [ 'frame_time_p50', 'frame_time_p95', 'frame_time_p99', 'peak_rss', 'st_save_time', 'st_load_time' ]
+
+# Path of the machine-readable summary of all benchmark runs.
+SUMMARY_PATH = "benchmark_summary.json"
+summary = []
+
 # If left empty, HEAD~1 will be used.
 old_commit_hash = ""
 
@@ -51,18 +62,17 @@ def run_mupen(name, additional_args):
 
     print(f"Running {' '.join(args)}")
     
-    fps_sum = 0
+    sums = {}
 
     for i in range(WARMUP_RUN_COUNT + NORMAL_RUN_COUNT):
         subprocess.run(args, timeout=120)
-        if i > WARMUP_RUN_COUNT:
+        if i >= WARMUP_RUN_COUNT:
             with open(benchmark_path) as f:
                 data = json.load(f)
-                fps_sum += data['fps']
+                for key in [ 'fps', *REPORTED_METRICS ]:
+                    sums[key] = sums.get(key, 0) + data.get(key, 0)
     
-    fps_avg = fps_sum / NORMAL_RUN_COUNT
-    
-    return { 'fps': fps_avg } 
+    return { key: value / NORMAL_RUN_COUNT for key, value in sums.items() }
 
 def run_benchmark_full(name, additional_args=[]):
     subprocess.run(['git', 'stash', 'push', '-u', '-m', 'benchmark'], stderr=subprocess.DEVNULL, stdout=subprocess.DEVNULL)
@@ -102,9 +112,18 @@ def run_benchmark_full(name, additional_args=[]):
         print("Within margin of error.")
     else:
         print(percentage_change > 0 and "IMPROVEMENT" or "REGRESSION")
+    for metric in REPORTED_METRICS:
+        old_value = benchmark_old.get(metric, 0)
+        new_value = benchmark_new.get(metric, 0)
+        metric_change = ((new_value - old_value) / old_value) * 100 if old_value else 0
+        if metric in LOWER_IS_BETTER_METRICS:
+            metric_change = -metric_change
+        print(f"{metric}: {old_value:.2f} (old) | {new_value:.2f} (new) | {metric_change:+.2f}%")
     print("------")
 
-def create_config():
+    summary.append({ 'name': name, 'old_commit': old_commit_hash, 'new_commit': new_commit_hash, 'old': benchmark_old, 'new': benchmark_new, 'regression': not within_margin_of_error and percentage_change < 0 })
+
+def create_config(core_type=1):
     '''
     Creates a config file with some default values filled in, while deleting any existing config.
     '''
@@ -121,20 +140,25 @@ def create_config():
     config.set("config", "selected_audio_plugin", "../plugins/NoAudio-x86.dll")
     config.set("config", "selected_input_plugin", "../plugins/NoInput-x86.dll")
     config.set("config", "selected_rsp_plugin", "../plugins/NoRSP-x86.dll")
+    config.set("config", "core_type", str(core_type))
 
     with open(CONFIG_INI_PATH, 'w+') as configfile:
         config.write(configfile)
 
 def main():
     build()
-    create_config()
     fill_commit_hashes()
 
     print(f"Running benchmarks for {old_commit_hash} vs {new_commit_hash}...")
-    run_benchmark_full("normal")
-    run_benchmark_full("with-dummy-lua", ["-lua", "dummy.lua"])
+    for core_type, core_name in CORE_TYPES.items():
+        create_config(core_type)
+        run_benchmark_full(f"normal-{core_name}")
+        run_benchmark_full(f"with-dummy-lua-{core_name}", ["-lua", "dummy.lua"])
     
     # TODO: Add more benchmarks here.  
+
+    with open(SUMMARY_PATH, 'w') as f:
+        json.dump(summary, f, indent=4)
     
 
 if __name__ == "__main__":
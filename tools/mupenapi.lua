@@ -96,6 +96,11 @@ Mupen = {
         pl_load_library_failed = 32,
         -- The plugin doesn't export a GetDllInfo function
         pl_no_get_dll_info = 33,
+
+        -- The watch range or kind is invalid
+        dbg_invalid_watch = 34,
+        -- No watch with the provided identifier exists
+        dbg_watch_not_found = 35,
     },
 }
 
@@ -152,6 +157,7 @@ function emu.statusbar(message) end
 
 ---Calls the function `f` every VI frame.
 ---For example, in Super Mario 64, the function will be called twice when you advance by one frame, whereas it will be called once in Ocarina of Time.
+---If the "Asynchronous Callbacks" option is enabled, emulation doesn't wait for this callback to run, so memory reads may see a later frame and memory writes, savestate operations or `emu.pause` calls take effect at an unpredictable point. The same applies to the other event callbacks, except for `emu.atinput`, `emu.atwindowmessage` and the drawing callbacks.
 ---If `unregister` is set to true, the function `f` will no longer be called when this event occurs, but it will error if you never registered the function.
 ---@param f fun(): nil The function to be called every VI frame.
 ---@param unregister boolean? If true, then unregister the function `f`.
@@ -522,6 +528,55 @@ function memory.writedouble(address, data) end
 ---@return nil
 function memory.writesize(address, size, data) end
 
+---@alias valuetype 1|2|4|8|-1|-2|-4|-8|"float"|"double"
+
+---Reads `length` bytes from memory starting at `address` and returns them as a string, in the console's byte order.
+---Use `string.byte` or `string.unpack` with big-endian formats to decode the block.
+---@nodiscard
+---@param address integer
+---@param length integer
+---@return string
+function memory.readblock(address, length) end
+
+---Writes the bytes of `data` to memory starting at `address`, in the console's byte order.
+---@param address integer
+---@param data string
+---@return nil
+function memory.writeblock(address, data) end
+
+---Reads several values relative to `address` in one call.
+---`layout` maps field names to `{offset, type}` pairs, and the result maps the same names to the values read at `address + offset`.
+---Unlike the other read functions, 8-byte values are returned as integers instead of qwords.
+---@nodiscard
+---@param address integer
+---@param layout table<any, [integer, valuetype]>
+---@return table<any, integer|number>
+function memory.readstruct(address, layout) end
+
+---Reads a value of the specified type at each address in `addresses`, and returns them in the same order.
+---Unlike the other read functions, 8-byte values are returned as integers instead of qwords.
+---@nodiscard
+---@param addresses integer[]
+---@param type valuetype
+---@return (integer|number)[]
+function memory.gather(addresses, type) end
+
+---Adds a watch over `size` bytes of memory starting at `address`, and calls `callback` on every matching access.
+---`kinds` is a combination of `"r"` (reads), `"w"` (writes) and `"x"` (executions).
+---Execution watches are only reported by the pure interpreter, so adding one under another core raises an error.
+---The `pc` passed to `callback` is always 0 under the dynamic recompiler.
+---@param address integer
+---@param size integer
+---@param kinds string
+---@param callback fun(address: integer, size: integer, kind: "r"|"w"|"x", value: integer, pc: integer): nil
+---@return integer id The watch's identifier.
+function memory.addwatch(address, size, kinds, callback) end
+
+---Removes a watch added with [memory.addwatch](lua://memory.addwatch).
+---@param id integer
+---@return nil
+function memory.removewatch(id) end
+
 ---See [memory.recompile](lua://memory.recompile).
 ---@param addr integer
 function memory.recompilenow(addr) end